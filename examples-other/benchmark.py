@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+
+# Runs parameter grids for the examples implemented both in DSLab (examples/) and in other
+# simulators (examples-other/) and prints the results as a single table.
+#
+# SimGrid and WRENCH examples print a machine-readable line
+#
+#   RESULT {"example": ..., "wall_time": ..., "setup_time": ..., "run_time": ..., "sim_time": ...,
+#           "events": ..., "events_per_sec": ..., "setup_rss_kb": ..., "peak_rss_kb": ...}
+#
+# while DSLab examples are parsed from their human-readable output. Peak RSS of every run is measured
+# by this script via wait4(), so it is available for all simulators. Note that DSLab reports engine
+# events, while SimGrid examples report logical events (messages, tasks, requests), so events/s are
+# comparable only within a simulator. Use --csv to save the table and compare it between revisions.
+#
+# Paths are relative to DSLAB_BASE_DIR (repository root by default). Examples:
+#
+#   examples-other/benchmark.py master-workers --hosts 10,100 --tasks 1000,100000
+#   examples-other/benchmark.py ping-pong --procs 2,1000 --peers 1,10 --iterations 1000
+#   examples-other/benchmark.py storage --requests 1000,100000 --disks 1,10
+#   examples-other/benchmark.py storage --requests 100000 --disk-profiles linear,degradation,mixed
+#   examples-other/benchmark.py dag --workflows examples/dag-benchmark/dags/montage.json
+
+import argparse
+import csv
+import itertools
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+
+BASE_DIR = os.getenv("DSLAB_BASE_DIR", os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+DSLAB_BIN_DIR = "target/release"
+SIMGRID_BIN_DIR = "examples-other/simgrid/build/release/bin"
+WRENCH_BINARY_PATH = "examples-other/wrench/dag/wrench-example-real-workflow"
+
+SIMGRID_ADDITIONAL_ARGS = ["--log=root.thres:critical"]
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+
+COLUMNS = ["benchmark", "params", "simulator", "sim_time", "setup_time", "run_time", "events",
+           "events_per_sec", "peak_rss_kb", "run_time_ratio"]
+
+
+class RunError(Exception):
+    pass
+
+
+def run(command):
+    """Runs the command and returns its stdout, elapsed wall time and peak RSS in KB."""
+    command = [str(x) for x in command]
+    start = time.monotonic()
+    proc = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+    output = proc.stdout.read()
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall_time = time.monotonic() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    proc.stdout.close()
+    if proc.returncode != 0:
+        raise RunError(f"\"{' '.join(command)}\" exited with code {proc.returncode}")
+    return output, wall_time, usage.ru_maxrss
+
+
+def search(regex, output, group_types):
+    m = re.search(regex, output)
+    if m is None:
+        raise RunError(f"output does not match \"{regex}\"")
+    return [t(x) for t, x in zip(group_types, m.groups())]
+
+
+def parse_duration(value, unit):
+    """Parses Rust Duration printed with {:?}."""
+    scale = {"s": 1., "ms": 1e-3, "µs": 1e-6, "us": 1e-6, "ns": 1e-9}
+    return float(value) * scale[unit]
+
+
+def run_dslab(command, run_time_regex, sim_time_regex=None, run_time_in_ms=False):
+    output, wall_time, peak_rss = run(command)
+    run_time, = search(run_time_regex, output, [float])
+    if run_time_in_ms:
+        run_time /= 1000
+    events, = search(r"Processed (\d+) events", output, [int])
+    sim_time = search(sim_time_regex, output, [float])[0] if sim_time_regex else None
+    return {
+        "sim_time": sim_time,
+        "setup_time": max(wall_time - run_time, 0.),
+        "run_time": run_time,
+        "events": events,
+        "events_per_sec": events / run_time if run_time > 0 else None,
+        "peak_rss_kb": peak_rss,
+    }
+
+
+def run_with_result_line(command):
+    output, _, peak_rss = run(command)
+    m = RESULT_REGEX.search(output)
+    if m is None:
+        raise RunError(f"\"{' '.join(map(str, command))}\" did not print RESULT line")
+    result = json.loads(m.group(1))
+    result["peak_rss_kb"] = peak_rss
+    return result
+
+
+def master_workers(args):
+    for hosts, tasks in itertools.product(args.hosts, args.tasks):
+        params = f"hosts={hosts} tasks={tasks}"
+        yield params, "dslab", lambda: run_dslab(
+            [f"{BASE_DIR}/{DSLAB_BIN_DIR}/master-workers", "--host-count", hosts,
+             "--task-count", tasks],
+            r"Elapsed time: ([\d\.]+)s", r"Processed \d+ tasks on \d+ hosts in ([\d\.]+)s")
+        yield params, "simgrid", lambda: run_with_result_line(
+            [f"{BASE_DIR}/{SIMGRID_BIN_DIR}/master-workers", hosts, tasks]
+            + SIMGRID_ADDITIONAL_ARGS)
+
+
+def ping_pong(args):
+    platform = f"{BASE_DIR}/examples-other/simgrid/ping-pong/platform.xml"
+    for procs, peers, iterations in itertools.product(args.procs, args.peers, args.iterations):
+        params = f"procs={procs} peers={peers} iterations={iterations}"
+        yield params, "dslab", lambda: run_dslab(
+            [f"{BASE_DIR}/{DSLAB_BIN_DIR}/ping-pong", "--proc-count", procs, "--peer-count", peers,
+             "--iterations", iterations],
+            r"Processed \d+ iterations in ([\d\.]+)s")
+        yield params, "simgrid", lambda: run_with_result_line(
+            [f"{BASE_DIR}/{SIMGRID_BIN_DIR}/ping-pong", procs, peers, 0, 0, iterations, platform]
+            + SIMGRID_ADDITIONAL_ARGS)
+
+
+def storage(args):
+    for requests, disks in itertools.product(args.requests, args.disks):
+        params = f"requests={requests} disks={disks}"
+        common_args = ["--requests", requests, "--disks", disks, "--max-size", args.max_size,
+                       "--max-start-time", args.max_start_time]
+        yield params, "dslab", lambda: run_dslab(
+            [f"{BASE_DIR}/{DSLAB_BIN_DIR}/storage-disk-benchmark"] + common_args,
+            r"Processed \d+ requests in (\d+) ms", run_time_in_ms=True)
+        # DSLab disks are linear and read-only, other SimGrid profiles are reported as separate
+        # simulators to measure the cost of each disk model against the same DSLab run
+        for profile in args.disk_profiles:
+            simulator = "simgrid" if profile == "linear" else f"simgrid/{profile}"
+            yield params, simulator, lambda: run_with_result_line(
+                [f"{BASE_DIR}/{SIMGRID_BIN_DIR}/storage"] + common_args
+                + ["--disk-profile", profile] + SIMGRID_ADDITIONAL_ARGS)
+
+
+def dag(args):
+    def run_dag_benchmark(workflow):
+        output, wall_time, peak_rss = run(
+            [f"{BASE_DIR}/{DSLAB_BIN_DIR}/dag-benchmark", f"{BASE_DIR}/{args.system}",
+             f"{BASE_DIR}/{workflow}"])
+        events, run_time, unit = search(r"Processed (\d+) events in ([\d\.]+)(\D+) \(",
+                                        output, [int, str, str])
+        run_time = parse_duration(run_time, unit)
+        sim_time, = search(r"Processed \d+ tasks in ([\d\.]+) \(simulation time\)", output,
+                           [float])
+        return {
+            "sim_time": sim_time,
+            "setup_time": max(wall_time - run_time, 0.),
+            "run_time": run_time,
+            "events": events,
+            "events_per_sec": events / run_time if run_time > 0 else None,
+            "peak_rss_kb": peak_rss,
+        }
+
+    for workflow in args.workflows:
+        params = f"workflow={os.path.basename(workflow)}"
+        yield params, "dslab", lambda: run_dag_benchmark(workflow)
+        yield params, "wrench", lambda: run_with_result_line(
+            [f"{BASE_DIR}/{WRENCH_BINARY_PATH}", f"{BASE_DIR}/{args.platform}",
+             f"{BASE_DIR}/{workflow}", "--online-stats"] + SIMGRID_ADDITIONAL_ARGS)
+
+
+def format_value(value):
+    if value is None:
+        return "-"
+    if isinstance(value, float):
+        return f"{value:.3f}" if value < 1000 else f"{value:.0f}"
+    return str(value)
+
+
+def print_table(rows):
+    header = COLUMNS
+    table = [[format_value(row.get(c)) for c in header] for row in rows]
+    widths = [max(len(x) for x in column) for column in zip(header, *table)]
+    for line in [header] + table:
+        print("  ".join(x.ljust(w) for x, w in zip(line, widths)).rstrip())
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--simulators", default="dslab,simgrid,wrench",
+                    help="Comma-separated list of simulators to run")
+    ap.add_argument("--csv", help="Save the results to CSV file")
+
+    def int_list(value):
+        return [int(x) for x in value.split(",")]
+
+    subparsers = ap.add_subparsers(dest="benchmark", required=True)
+
+    mw = subparsers.add_parser("master-workers")
+    mw.add_argument("--hosts", type=int_list, default=[10, 100])
+    mw.add_argument("--tasks", type=int_list, default=[1000, 10000])
+    mw.set_defaults(grid=master_workers)
+
+    pp = subparsers.add_parser("ping-pong")
+    pp.add_argument("--procs", type=int_list, default=[2, 100])
+    pp.add_argument("--peers", type=int_list, default=[1])
+    pp.add_argument("--iterations", type=int_list, default=[1000])
+    pp.set_defaults(grid=ping_pong)
+
+    st = subparsers.add_parser("storage")
+    st.add_argument("--requests", type=int_list, default=[1000, 10000])
+    st.add_argument("--disks", type=int_list, default=[1, 10])
+    st.add_argument("--max-size", type=int, default=10**9 + 6)
+    st.add_argument("--max-start-time", type=int, default=0)
+    st.add_argument("--disk-profiles", type=lambda x: x.split(","), default=["linear"],
+                    help="Comma-separated list of SimGrid disk profiles (linear, degradation, "
+                         "size-bandwidth, mixed)")
+    st.set_defaults(grid=storage)
+
+    dg = subparsers.add_parser("dag")
+    dg.add_argument("--workflows", type=lambda x: x.split(","),
+                    default=["examples/dag-benchmark/dags/montage.json"])
+    dg.add_argument("--system", default="examples/dag-benchmark/systems/001.yaml",
+                    help="DSLab system description")
+    dg.add_argument("--platform", default="examples-other/wrench/dag/cloud_batch_platform.xml",
+                    help="WRENCH platform description")
+    dg.set_defaults(grid=dag)
+
+    args = ap.parse_args()
+    simulators = set(args.simulators.split(","))
+
+    rows = []
+    dslab_run_times = {}
+    for params, simulator, run_benchmark in args.grid(args):
+        if simulator.split("/")[0] not in simulators:
+            continue
+        row = {"benchmark": args.benchmark, "params": params, "simulator": simulator}
+        try:
+            row.update(run_benchmark())
+        except (RunError, OSError) as e:
+            print(f"{args.benchmark} {params} {simulator}: {e}", file=sys.stderr)
+            continue
+        if simulator == "dslab":
+            dslab_run_times[params] = row["run_time"]
+        elif dslab_run_times.get(params):
+            row["run_time_ratio"] = row["run_time"] / dslab_run_times[params]
+        rows.append(row)
+
+    print_table(rows)
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=COLUMNS, extrasaction="ignore")
+            writer.writeheader()
+            writer.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
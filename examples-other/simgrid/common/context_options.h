@@ -0,0 +1,72 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dslab::simgrid_examples {
+
+// Command-line options controlling how SimGrid runs actors:
+//
+//   --context-factory NAME  actor context factory: thread, ucontext, raw or boost
+//   --nthreads N            number of threads running actors in parallel, 1 means sequential
+//   --stack-size KIB        actor stack size
+//
+// The raw factory has the cheapest context switch, the thread factory uses a system thread per
+// actor and is mainly useful for debugging. With N > 1 actors ready at the same simulated time run
+// in parallel, which pays off only when actors do substantial work between simcalls.
+//
+// The options are converted to the corresponding --cfg=contexts/... options, so the arguments
+// should be passed to the engine constructor instead of the original ones: the context factory is
+// chosen during engine initialization and cannot be changed later with Engine::set_config().
+class ContextArguments {
+public:
+    ContextArguments(int argc, char** argv) {
+        static constexpr std::pair<std::string_view, std::string_view> kOptions[] = {
+            {"--context-factory", "contexts/factory"},
+            {"--nthreads", "contexts/nthreads"},
+            {"--stack-size", "contexts/stack-size"},
+        };
+        for (int i = 0; i < argc; i++) {
+            std::string_view arg = argv[i];
+            bool converted = false;
+            for (const auto& [option, cfg] : kOptions) {
+                std::string value;
+                if (arg == option && i + 1 < argc) {
+                    value = argv[++i];
+                } else if (arg.size() > option.size() && arg.substr(0, option.size()) == option &&
+                           arg[option.size()] == '=') {
+                    value = arg.substr(option.size() + 1);
+                } else {
+                    continue;
+                }
+                cfg_args_.push_back("--cfg=" + std::string(cfg) + ":" + value);
+                argv_.push_back(cfg_args_.back().data());
+                converted = true;
+                break;
+            }
+            if (!converted) {
+                argv_.push_back(argv[i]);
+            }
+        }
+        argc_ = static_cast<int>(argv_.size());
+        argv_.push_back(nullptr);
+    }
+
+    int* Argc() {
+        return &argc_;
+    }
+
+    char** Argv() {
+        return argv_.data();
+    }
+
+private:
+    std::deque<std::string> cfg_args_;  // deque keeps pointers to stored strings valid
+    std::vector<char*> argv_;
+    int argc_ = 0;
+};
+
+}  // namespace dslab::simgrid_examples
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <simgrid/s4u.hpp>
+#include <xbt/asserts.h>
+
+namespace dslab::simgrid_examples {
+
+// Fixed-size binary event record, written as is (little-endian) to the trace file
+struct EventRecord {
+    double time;
+    uint32_t actor;  // actor pid
+    uint16_t type;   // index in the event names passed to EventTracer
+    uint16_t reserved;
+    int64_t id0;  // event-specific ids, e.g. process or task id
+    int64_t id1;
+};
+static_assert(sizeof(EventRecord) == 32, "event trace layout");
+
+// Trace file header, followed by event_count records, event names and actor names (by pid), each
+// name is stored as uint16_t length followed by characters.
+struct EventTraceHeader {
+    char magic[8];
+    uint64_t event_count;
+    uint64_t dropped_count;
+    uint32_t event_type_count;
+    uint32_t actor_count;
+};
+static_assert(sizeof(EventTraceHeader) == 32, "event trace layout");
+
+static inline constexpr char kEventTraceMagic[8] = {'S', 'G', 'E', 'V', 'E', 'N', 'T', '1'};
+
+// Binary event tracer for hot paths of the examples, enabled with --event-trace option, which
+// replaces logging when full logs are too slow. Events are stored in a preallocated buffer without
+// any formatting and decoded offline with decode-event-trace.py. In the default stream mode the
+// buffer is written to the file each time it is full, so all events are kept. In the ring mode
+// (ring_capacity > 0) only the last ring_capacity events are kept and written at Close().
+//
+// The buffer and the counters are protected by a spinlock (as in ObjectPool), so events can be
+// recorded from actors running in parallel contexts (--nthreads > 1). The order of records from
+// different threads within the same simulated time is then not deterministic.
+//
+// Like Instrumentation, should be created before actors to collect actor names.
+class EventTracer {
+public:
+    EventTracer(const std::string& path, std::vector<std::string> event_names,
+                size_t ring_capacity = 0)
+        : event_names_(std::move(event_names)),
+          ring_(ring_capacity > 0),
+          buffer_(ring_ ? ring_capacity : kStreamBufferSize) {
+        file_ = fopen(path.c_str(), "wb");
+        xbt_assert(file_ != nullptr, "Cannot open event trace %s", path.c_str());
+        // the header is rewritten with the counts at Close()
+        EventTraceHeader header{};
+        fwrite(&header, sizeof(header), 1, file_);
+        simgrid::s4u::Actor::on_creation.connect([this](simgrid::s4u::Actor& actor) {
+            auto pid = static_cast<size_t>(actor.get_pid());
+            if (pid >= actor_names_.size()) {
+                actor_names_.resize(pid + 1);
+            }
+            actor_names_[pid] = actor.get_name();
+        });
+        active_ = this;
+    }
+
+    EventTracer(const EventTracer&) = delete;
+    EventTracer& operator=(const EventTracer&) = delete;
+
+    ~EventTracer() {
+        Close();
+    }
+
+    // Tracer receiving events recorded with RecordEvent(), nullptr if tracing is disabled
+    static EventTracer* Active() {
+        return active_;
+    }
+
+    template <typename EventType>
+    void Record(EventType type, int64_t id0, int64_t id1) {
+        double time = simgrid::s4u::Engine::get_clock();
+        auto actor = static_cast<uint32_t>(simgrid::s4u::this_actor::get_pid());
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+        }
+        auto& record = buffer_[size_];
+        record.time = time;
+        record.actor = actor;
+        record.type = static_cast<uint16_t>(type);
+        record.reserved = 0;
+        record.id0 = id0;
+        record.id1 = id1;
+        if (++size_ == buffer_.size()) {
+            OnBufferFull();
+        }
+        lock_.clear(std::memory_order_release);
+    }
+
+    // Writes the remaining events and names, the trace is complete after this call
+    void Close() {
+        if (file_ == nullptr) {
+            return;
+        }
+        if (active_ == this) {
+            active_ = nullptr;
+        }
+        if (ring_ && wrapped_) {
+            // the oldest kept event is at the current position
+            fwrite(buffer_.data() + size_, sizeof(EventRecord), buffer_.size() - size_, file_);
+            written_count_ += buffer_.size() - size_;
+        }
+        fwrite(buffer_.data(), sizeof(EventRecord), size_, file_);
+        written_count_ += size_;
+        recorded_count_ += size_;
+        size_ = 0;
+        for (const auto& name : event_names_) {
+            WriteName(name);
+        }
+        for (const auto& name : actor_names_) {
+            WriteName(name);
+        }
+        EventTraceHeader header{};
+        memcpy(header.magic, kEventTraceMagic, sizeof(header.magic));
+        header.event_count = written_count_;
+        header.dropped_count = GetDroppedCount();
+        header.event_type_count = static_cast<uint32_t>(event_names_.size());
+        header.actor_count = static_cast<uint32_t>(actor_names_.size());
+        fseek(file_, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, file_);
+        fclose(file_);
+        file_ = nullptr;
+    }
+
+    uint64_t GetWrittenCount() const {
+        return written_count_;
+    }
+
+    // Number of events overwritten in the ring mode
+    uint64_t GetDroppedCount() const {
+        return recorded_count_ - written_count_;
+    }
+
+private:
+    static inline constexpr size_t kStreamBufferSize = 1 << 16;
+
+    void OnBufferFull() {
+        size_ = 0;
+        recorded_count_ += buffer_.size();
+        if (ring_) {
+            wrapped_ = true;
+            return;
+        }
+        fwrite(buffer_.data(), sizeof(EventRecord), buffer_.size(), file_);
+        written_count_ += buffer_.size();
+    }
+
+    void WriteName(const std::string& name) {
+        auto length = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+        fwrite(&length, sizeof(length), 1, file_);
+        fwrite(name.data(), 1, length, file_);
+    }
+
+    static inline EventTracer* active_ = nullptr;
+
+    std::vector<std::string> event_names_;
+    std::vector<std::string> actor_names_;
+    bool ring_;
+    bool wrapped_ = false;
+    std::vector<EventRecord> buffer_;
+    size_t size_ = 0;
+    uint64_t written_count_ = 0;
+    uint64_t recorded_count_ = 0;
+    FILE* file_ = nullptr;
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+};
+
+// Records event of the current actor if tracing is enabled, costs a single branch otherwise
+template <typename EventType>
+inline void RecordEvent(EventType type, int64_t id0 = 0, int64_t id1 = 0) {
+    if (auto* tracer = EventTracer::Active()) {
+        tracer->Record(type, id0, id1);
+    }
+}
+
+}  // namespace dslab::simgrid_examples
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dslab::simgrid_examples {
+
+// Histogram of non-negative values with fixed log-linear buckets (similar to HdrHistogram).
+//
+// Each power of two range [2^e, 2^(e+1)) is split into kSubBuckets equal buckets, so the reported
+// quantiles are within 1/kSubBuckets relative error. Values below 2^kMinExponent and above
+// 2^kMaxExponent are clamped to the first and the last bucket, the maximum is tracked exactly.
+// Only the buckets between the smallest and the largest recorded power of two range are stored, so
+// a histogram of values of similar magnitude (e.g. round-trip times of a process) takes a few
+// hundred bytes instead of all kBucketCount counters. Recording a value allocates memory only
+// when it extends this range.
+class Histogram {
+public:
+    void Record(double value) {
+        ++Counter(BucketIndex(value));
+        ++count_;
+        max_ = std::max(max_, value);
+    }
+
+    void Merge(const Histogram& other) {
+        for (size_t i = 0; i < other.counts_.size(); i++) {
+            if (other.counts_[i] != 0) {
+                Counter(other.first_bucket_ + i) += other.counts_[i];
+            }
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t GetCount() const {
+        return count_;
+    }
+
+    double GetMax() const {
+        return max_;
+    }
+
+    // Returns the upper bound of the bucket containing q-quantile, 0 <= q <= 1
+    double GetQuantile(double q) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * count_)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); i++) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(BucketUpperBound(first_bucket_ + i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr int kSubBuckets = 16;
+    static constexpr int kMinExponent = -40;  // ~1e-12
+    static constexpr int kMaxExponent = 24;   // ~1.7e7
+    static constexpr size_t kBucketCount = (kMaxExponent - kMinExponent) * kSubBuckets + 2;
+
+    static size_t BucketIndex(double value) {
+        if (!(value >= std::ldexp(1., kMinExponent))) {
+            return 0;
+        }
+        if (value >= std::ldexp(1., kMaxExponent)) {
+            return kBucketCount - 1;
+        }
+        int exponent = 0;
+        double mantissa = std::frexp(value, &exponent);  // value = mantissa * 2^exponent
+        auto sub_bucket = static_cast<int>((mantissa * 2 - 1) * kSubBuckets);
+        return 1 + (exponent - 1 - kMinExponent) * kSubBuckets + sub_bucket;
+    }
+
+    // Returns the indices [first, end) of the power of two range containing the bucket, the first
+    // and the last buckets form ranges of their own
+    static std::pair<size_t, size_t> BucketRange(size_t index) {
+        if (index == 0 || index == kBucketCount - 1) {
+            return {index, index + 1};
+        }
+        size_t first = index - (index - 1) % kSubBuckets;
+        return {first, first + kSubBuckets};
+    }
+
+    static double BucketUpperBound(size_t index) {
+        if (index == 0) {
+            return std::ldexp(1., kMinExponent);
+        }
+        if (index == kBucketCount - 1) {
+            return INFINITY;
+        }
+        int exponent = static_cast<int>(index - 1) / kSubBuckets + kMinExponent;
+        int sub_bucket = static_cast<int>(index - 1) % kSubBuckets;
+        return std::ldexp(1. + static_cast<double>(sub_bucket + 1) / kSubBuckets, exponent);
+    }
+
+    uint32_t& Counter(size_t index) {
+        if (counts_.empty() || index < first_bucket_ || index >= first_bucket_ + counts_.size()) {
+            Extend(index);
+        }
+        return counts_[index - first_bucket_];
+    }
+
+    // Extends the stored buckets to the whole power of two range containing the bucket
+    void Extend(size_t index) {
+        auto [first, end] = BucketRange(index);
+        if (!counts_.empty()) {
+            end = std::max(end, first_bucket_ + counts_.size());
+            first = std::min(first, first_bucket_);
+            counts_.insert(counts_.begin(), first_bucket_ - first, 0);
+        }
+        counts_.resize(end - first);
+        first_bucket_ = first;
+    }
+
+    // counters of buckets [first_bucket_, first_bucket_ + counts_.size()), 32-bit counters keep
+    // the histogram small, it is allocated per process
+    std::vector<uint32_t> counts_;
+    size_t first_bucket_ = 0;
+    uint64_t count_ = 0;
+    double max_ = 0;
+};
+
+}  // namespace dslab::simgrid_examples
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+#include <simgrid/s4u.hpp>
+
+#include "histogram.h"
+#include "run_stats.h"
+
+namespace dslab::simgrid_examples {
+
+// Opt-in instrumentation of a simulation run, enabled with --instrument option of the examples.
+//
+// Counts activities started and completed per type (comm, exec, io, sleep), actors created and
+// engine time advances using s4u signals, and prints a summary table with Print(). The engine
+// solves the max-min (LMM) system once per scheduling round and advances the clock after it, so
+// time advances are the number of solver invocations, and wall time between them is the cost of a
+// round (running ready actors plus solving). SimGrid does not expose context switches, so they are
+// estimated as two per simcall (to maestro and back) for each activity start, completion (wait) and
+// sleep, which is a lower bound.
+//
+// Should be created before actors, since the counters are updated by signal callbacks connected in
+// the constructor, and kept alive until the end of the simulation.
+class Instrumentation {
+public:
+    Instrumentation() : start_(std::chrono::steady_clock::now()) {
+        namespace sg4 = simgrid::s4u;
+        sg4::Actor::on_creation.connect([this](sg4::Actor&) { ++actors_created_; });
+        sg4::Comm::on_start.connect([this](const sg4::Comm&) { ++comm_.started; });
+        sg4::Exec::on_start.connect([this](const sg4::Exec&) { ++exec_.started; });
+        sg4::Io::on_start.connect([this](const sg4::Io&) { ++io_.started; });
+        sg4::Actor::on_sleep.connect([this](const sg4::Actor&) { ++sleep_.started; });
+        sg4::Actor::on_wake_up.connect([this](const sg4::Actor&) { ++sleep_.completed; });
+        sg4::Activity::on_completion.connect([this](const sg4::Activity& activity) {
+            if (dynamic_cast<const sg4::Comm*>(&activity) != nullptr) {
+                ++comm_.completed;
+            } else if (dynamic_cast<const sg4::Exec*>(&activity) != nullptr) {
+                ++exec_.completed;
+            } else if (dynamic_cast<const sg4::Io*>(&activity) != nullptr) {
+                ++io_.completed;
+            }
+        });
+        sg4::Engine::on_time_advance.connect([this](double) {
+            auto now = std::chrono::steady_clock::now();
+            round_wall_times_.Record(ToSeconds(now - last_round_));
+            last_round_ = now;
+        });
+    }
+
+    Instrumentation(const Instrumentation&) = delete;
+    Instrumentation& operator=(const Instrumentation&) = delete;
+
+    void RunStarted() {
+        run_start_ = last_round_ = std::chrono::steady_clock::now();
+    }
+
+    void RunDone() {
+        run_stop_ = std::chrono::steady_clock::now();
+    }
+
+    void Print() const {
+        double run_time = ToSeconds(run_stop_ - run_start_);
+        uint64_t rounds = round_wall_times_.GetCount();
+        printf("Instrumentation summary\n");
+        printf("  %-24s %12.3f s\n", "setup wall time", ToSeconds(run_start_ - start_));
+        printf("  %-24s %12.3f s\n", "run wall time", run_time);
+        printf("  %-24s %12lu\n", "actors created", static_cast<unsigned long>(actors_created_));
+        printf("  %-24s %12lu  (%.0f/s, mean %.3g s, p99 %.3g s, max %.3g s per round)\n",
+               "solver rounds", static_cast<unsigned long>(rounds),
+               run_time > 0 ? rounds / run_time : 0., rounds > 0 ? run_time / rounds : 0.,
+               round_wall_times_.GetQuantile(0.99), round_wall_times_.GetMax());
+        printf("  %-24s %12s %12s\n", "activity", "started", "completed");
+        const std::pair<const char*, const ActivityCounters*> rows[] = {
+            {"comm", &comm_}, {"exec", &exec_}, {"io", &io_}, {"sleep", &sleep_}};
+        uint64_t simcalls = 0;
+        for (const auto& [name, counters] : rows) {
+            printf("  %-24s %12lu %12lu\n", name, static_cast<unsigned long>(counters->started),
+                   static_cast<unsigned long>(counters->completed));
+            // a sleep is a single blocking simcall, an activity is started and waited for
+            simcalls += counters->started + (counters == &sleep_ ? 0 : counters->completed);
+        }
+        printf("  %-24s %12lu\n", "context switches (est.)",
+               static_cast<unsigned long>(2 * simcalls));
+        fflush(stdout);
+    }
+
+private:
+    struct ActivityCounters {
+        uint64_t started = 0;
+        uint64_t completed = 0;
+    };
+
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point run_start_;
+    std::chrono::steady_clock::time_point run_stop_;
+    std::chrono::steady_clock::time_point last_round_;
+    ActivityCounters comm_, exec_, io_, sleep_;
+    uint64_t actors_created_ = 0;
+    Histogram round_wall_times_;
+};
+
+}  // namespace dslab::simgrid_examples
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dslab::simgrid_examples {
+
+// Typed pool of objects which reuses the memory of destroyed objects via a free list.
+//
+// Memory is allocated in chunks and is returned to the system only at process exit. The free list
+// is protected by a spinlock, so objects can be created and destroyed from actors running in
+// parallel contexts.
+//
+// Define DISABLE_OBJECT_POOL (cmake -DDISABLE_OBJECT_POOL=ON) to fall back to plain new/delete.
+template <typename T>
+class ObjectPool {
+public:
+    template <typename... Args>
+    static T* New(Args&&... args) {
+#ifdef DISABLE_OBJECT_POOL
+        return new T(std::forward<Args>(args)...);
+#else
+        return new (Allocate()) T(std::forward<Args>(args)...);
+#endif
+    }
+
+    static void Delete(T* object) {
+#ifdef DISABLE_OBJECT_POOL
+        delete object;
+#else
+        object->~T();
+        Release(object);
+#endif
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static void* Allocate() {
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+        }
+        if (free_list_ == nullptr) {
+            auto& chunk = chunks_.emplace_back(std::make_unique<Slot[]>(kChunkSize));
+            for (size_t i = 0; i < kChunkSize; i++) {
+                chunk[i].next = free_list_;
+                free_list_ = &chunk[i];
+            }
+        }
+        Slot* slot = free_list_;
+        free_list_ = slot->next;
+        lock_.clear(std::memory_order_release);
+        return slot->storage;
+    }
+
+    static void Release(void* ptr) {
+        auto* slot = reinterpret_cast<Slot*>(ptr);
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+        }
+        slot->next = free_list_;
+        free_list_ = slot;
+        lock_.clear(std::memory_order_release);
+    }
+
+    static inline constexpr size_t kChunkSize = 1024;
+    static inline Slot* free_list_ = nullptr;
+    static inline std::vector<std::unique_ptr<Slot[]>> chunks_;
+    static inline std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+};
+
+template <typename T, typename... Args>
+T* PoolNew(Args&&... args) {
+    return ObjectPool<T>::New(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void PoolDelete(T* object) {
+    ObjectPool<T>::Delete(object);
+}
+
+}  // namespace dslab::simgrid_examples
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include <sys/resource.h>
+
+namespace dslab::simgrid_examples {
+
+// Returns peak resident set size of the process in KB
+inline long GetPeakRss() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+inline double ToSeconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+// Collects the metrics shared by all examples and prints them as a single machine-readable line:
+//
+//   RESULT {"example": "...", "wall_time": ..., "setup_time": ..., "run_time": ..., ...}
+//
+// Setup covers everything from construction till SetupDone() (platform, actors, input data), run
+// covers the simulation itself. SimGrid does not expose an engine event counter, so each example
+// reports its own logical events (messages, tasks, requests) and events/s is computed over run
+// time. The line is parsed by examples-other/benchmark.py.
+class RunStats {
+public:
+    explicit RunStats(std::string example)
+        : example_(std::move(example)), start_(std::chrono::steady_clock::now()) {
+    }
+
+    void SetupDone() {
+        setup_stop_ = std::chrono::steady_clock::now();
+        setup_rss_ = GetPeakRss();
+    }
+
+    void RunDone(double sim_time, uint64_t events) {
+        run_stop_ = std::chrono::steady_clock::now();
+        sim_time_ = sim_time;
+        events_ = events;
+    }
+
+    double GetSetupTime() const {
+        return ToSeconds(setup_stop_ - start_);
+    }
+
+    double GetRunTime() const {
+        return ToSeconds(run_stop_ - setup_stop_);
+    }
+
+    long GetSetupRss() const {
+        return setup_rss_;
+    }
+
+    void Print() const {
+        double run_time = GetRunTime();
+        printf(
+            "RESULT {\"example\": \"%s\", \"wall_time\": %.6f, \"setup_time\": %.6f, "
+            "\"run_time\": %.6f, \"sim_time\": %.6f, \"events\": %lu, \"events_per_sec\": %.1f, "
+            "\"setup_rss_kb\": %ld, \"peak_rss_kb\": %ld}\n",
+            example_.c_str(), ToSeconds(run_stop_ - start_), GetSetupTime(), run_time, sim_time_,
+            static_cast<unsigned long>(events_), run_time > 0 ? events_ / run_time : 0.,
+            setup_rss_, GetPeakRss());
+        fflush(stdout);
+    }
+
+private:
+    std::string example_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point setup_stop_;
+    std::chrono::steady_clock::time_point run_stop_;
+    double sim_time_ = 0;
+    uint64_t events_ = 0;
+    long setup_rss_ = 0;
+};
+
+}  // namespace dslab::simgrid_examples
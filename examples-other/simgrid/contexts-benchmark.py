@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+
+# Runs ping-pong or master-workers for all combinations of context factories and thread counts and
+# prints a matrix with run time, throughput (iterations/s for ping-pong, tasks/s for master-workers)
+# and peak RSS for each configuration.
+#
+# Example (from build directory):
+#
+#   ../../contexts-benchmark.py ping-pong --nthreads 1,2,4,8 -- 1000 10 0 0 100 ../../ping-pong/platform.xml
+#   ../../contexts-benchmark.py master-workers --factories raw,ucontext -- 1000 100000
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+
+
+def run(command):
+    proc = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+    m = RESULT_REGEX.search(proc.stdout)
+    if proc.returncode != 0 or m is None:
+        return None
+    return json.loads(m.group(1))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("example", choices=["ping-pong", "master-workers"])
+    ap.add_argument("--bin-dir", default="bin")
+    ap.add_argument("--factories", default="raw,ucontext,thread",
+                    help="Comma-separated list of context factories")
+    ap.add_argument("--nthreads", default="1,2,4",
+                    help="Comma-separated list of thread counts")
+    ap.add_argument("--stack-size", help="Actor stack size in KiB")
+    ap.add_argument("example_args", nargs="+", help="Arguments passed to the example (after --)")
+    args = ap.parse_args()
+
+    if args.example == "ping-pong":
+        # PROC_COUNT PEER_COUNT ASYMMETRIC DISTRIBUTED ITERATIONS platform_file.xml
+        units, unit_count = "iter/s", int(args.example_args[4])
+    else:
+        # HOST_COUNT TASK_COUNT
+        units, unit_count = "tasks/s", int(args.example_args[1])
+
+    header = ["factory", "nthreads", "run time, s", units, "peak RSS, KB"]
+    rows = []
+    for factory in args.factories.split(","):
+        for nthreads in args.nthreads.split(","):
+            command = [os.path.join(args.bin_dir, args.example)] + args.example_args + [
+                "--context-factory", factory, "--nthreads", nthreads, "--log=root.thres:critical"]
+            if args.stack_size:
+                command += ["--stack-size", args.stack_size]
+            print(f"Running {factory} with {nthreads} threads", file=sys.stderr)
+            result = run(command)
+            if result is None:
+                rows.append([factory, nthreads, "failed", "-", "-"])
+                continue
+            run_time = result["run_time"]
+            throughput = unit_count / run_time if run_time > 0 else 0
+            rows.append([factory, nthreads, f"{run_time:.3f}", f"{throughput:.1f}",
+                         str(result["peak_rss_kb"])])
+
+    widths = [max(len(x) for x in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(x.ljust(w) for x, w in zip(row, widths)).rstrip())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+
+# Decodes binary event traces recorded by the examples with --event-trace (see EventTracer in
+# common/event_trace.h) into CSV, a human-readable timeline or per-event counts.
+#
+# Examples (from build directory):
+#
+#   ./bin/ping-pong 1000 1 0 0 1000 ../../ping-pong/platform.xml --event-trace ping-pong.trace
+#   ../../decode-event-trace.py ping-pong.trace --format timeline | less
+#   ../../decode-event-trace.py ping-pong.trace --format csv --output ping-pong.csv
+#   ../../decode-event-trace.py ping-pong.trace --format summary
+
+import argparse
+import csv
+import struct
+import sys
+from collections import Counter
+
+
+# must match EventTraceHeader, EventRecord and kEventTraceMagic in common/event_trace.h
+MAGIC = b"SGEVENT1"
+HEADER = struct.Struct("<8sQQII")
+RECORD = struct.Struct("<dIHHqq")
+NAME_LENGTH = struct.Struct("<H")
+
+CSV_COLUMNS = ["time", "actor", "event", "id0", "id1"]
+
+
+class Trace:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        magic, self.event_count, self.dropped_count, event_type_count, actor_count = \
+            HEADER.unpack_from(data, 0)
+        if magic != MAGIC:
+            sys.exit(f"{path}: not an event trace (incomplete traces have no magic)")
+        self.records_offset = HEADER.size
+        offset = self.records_offset + self.event_count * RECORD.size
+        if offset > len(data):
+            sys.exit(f"{path}: truncated trace")
+        names = []
+        for _ in range(event_type_count + actor_count):
+            (length,) = NAME_LENGTH.unpack_from(data, offset)
+            offset += NAME_LENGTH.size
+            names.append(data[offset:offset + length].decode())
+            offset += length
+        self.event_names = names[:event_type_count]
+        self.actor_names = names[event_type_count:]
+        self.data = data
+
+    def event_name(self, event_type):
+        if event_type < len(self.event_names):
+            return self.event_names[event_type]
+        return str(event_type)
+
+    def actor_name(self, pid):
+        if pid < len(self.actor_names) and self.actor_names[pid]:
+            return self.actor_names[pid]
+        return f"actor-{pid}"
+
+    def records(self):
+        """Yields (time, actor name, event name, id0, id1) tuples in trace order."""
+        for time, pid, event_type, _, id0, id1 in RECORD.iter_unpack(
+                self.data[self.records_offset:self.records_offset + self.event_count * RECORD.size]):
+            yield time, self.actor_name(pid), self.event_name(event_type), id0, id1
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("trace", help="Event trace written with --event-trace")
+    ap.add_argument("--format", choices=["csv", "timeline", "summary"], default="csv")
+    ap.add_argument("--output", help="Output file (default stdout)")
+    args = ap.parse_args()
+
+    trace = Trace(args.trace)
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    if args.format == "csv":
+        writer = csv.writer(out)
+        writer.writerow(CSV_COLUMNS)
+        writer.writerows(trace.records())
+    elif args.format == "timeline":
+        actor_width = max((len(name) for name in trace.actor_names), default=0)
+        for time, actor, event, id0, id1 in trace.records():
+            out.write(f"[{time:14.6f}] {actor:<{actor_width}} {event} {id0} {id1}\n")
+    else:
+        counts = Counter()
+        first_time, last_time = {}, {}
+        for time, _, event, _, _ in trace.records():
+            counts[event] += 1
+            first_time.setdefault(event, time)
+            last_time[event] = time
+        out.write(f"{trace.event_count} events, {trace.dropped_count} dropped\n")
+        out.write(f"{'event':<24} {'count':>12} {'first':>14} {'last':>14}\n")
+        for event in trace.event_names:
+            if counts[event] > 0:
+                out.write(f"{event:<24} {counts[event]:>12} {first_time[event]:>14.6f} "
+                          f"{last_time[event]:>14.6f}\n")
+
+
+if __name__ == "__main__":
+    main()
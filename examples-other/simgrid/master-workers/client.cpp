@@ -1,28 +1,122 @@
 #include "client.h"
 
+#include <algorithm>
+
 #include <simgrid/s4u.hpp>
 #include <xbt/random.hpp>
 
+#include "event_trace.h"
+#include "object_pool.h"
+#include "trace.h"
+
+using dslab::simgrid_examples::PoolNew;
+using dslab::simgrid_examples::RecordEvent;
+
 XBT_LOG_NEW_DEFAULT_CATEGORY(client, "Client");
 
-Client::Client(std::string name, uint32_t task_count, sg4::Mailbox* master_mb,
-               simgrid::xbt::random::XbtRandom* random)
-    : task_count_(task_count), master_mb_(master_mb), random_(random) {
+Client::Client(std::string name, uint32_t task_count, uint32_t batch_size,
+               sg4::Mailbox* master_mb, simgrid::xbt::random::XbtRandom* random,
+               ClientStats& stats, uint32_t dataset_count)
+    : task_count_(task_count),
+      batch_size_(batch_size),
+      dataset_count_(dataset_count),
+      master_mb_(master_mb),
+      random_(random),
+      stats_(stats) {
+    mb_ = sg4::Mailbox::by_name(name);
+}
+
+Client::Client(std::string name, TraceReader* trace, uint32_t task_count, uint32_t window_size,
+               uint32_t batch_size, sg4::Mailbox* master_mb, ClientStats& stats)
+    : task_count_(task_count),
+      batch_size_(batch_size),
+      window_size_(window_size),
+      master_mb_(master_mb),
+      trace_(trace),
+      stats_(stats) {
     mb_ = sg4::Mailbox::by_name(name);
 }
 
 void Client::operator()() {
+    if (trace_ != nullptr) {
+        ReplayTrace();
+    } else {
+        GenerateTasks();
+    }
+    FlushBatch();
+    XBT_DEBUG("Exiting");
+}
+
+void Client::GenerateTasks() {
     // generate and submit tasks to master
+    std::vector<double> dataset_sizes(dataset_count_);
+    for (auto& size : dataset_sizes) {
+        size = random_->uniform_int(100, 1000) * 10e6;
+    }
     for (uint32_t i = 0; i < task_count_; i++) {
         int flops = random_->uniform_int(100, 1000);
         double memory = random_->uniform_int(1, 8) * 128;
         int cores = 1;
-        double input_size = random_->uniform_int(100, 1000) * 10e6;
+        int dataset_id = -1;
+        double input_size = 0;
+        if (dataset_count_ > 0) {
+            dataset_id = random_->uniform_int(0, static_cast<int>(dataset_count_) - 1);
+            input_size = dataset_sizes[dataset_id];
+        } else {
+            input_size = random_->uniform_int(100, 1000) * 10e6;
+        }
         double output_size = random_->uniform_int(10, 100) * 10e6;
-        auto* req =
-            new TaskRequest{static_cast<int>(i), flops, memory, cores, input_size, output_size};
-        auto* msg = new Message(MessageType::TASK_REQUEST, req, mb_);
+        Submit(PoolNew<TaskRequest>(static_cast<int>(i), flops, memory, cores, input_size,
+                                    output_size, dataset_id));
+    }
+}
+
+void Client::ReplayTrace() {
+    std::vector<TraceRecord> window(window_size_);
+    uint32_t task_id = 0;
+    while (task_id < task_count_) {
+        size_t count = trace_->Read(window.data(), std::min(window_size_, task_count_ - task_id));
+        xbt_assert(count > 0, "Trace ended after %u of %u tasks", task_id, task_count_);
+        for (size_t i = 0; i < count; i++) {
+            const auto& rec = window[i];
+            // tasks arriving later than the current time are submitted after the pending batch,
+            // records which are out of order are submitted immediately
+            if (rec.arrival_time > sg4::Engine::get_clock()) {
+                FlushBatch();
+                sg4::this_actor::sleep_until(rec.arrival_time);
+            }
+            Submit(PoolNew<TaskRequest>(static_cast<int>(task_id), rec.flops, rec.memory,
+                                        rec.cores, rec.input_size, rec.output_size,
+                                        rec.dataset_id));
+            task_id++;
+        }
+    }
+}
+
+void Client::Submit(TaskRequest* req) {
+    RecordEvent(MasterWorkersEvent::TASK_SUBMITTED, req->id);
+    if (batch_size_ <= 1) {
+        auto* msg = PoolNew<Message>(MessageType::TASK_REQUEST, req, mb_);
         master_mb_->put(msg, kMessagePayloadSize);
+        stats_.task_messages++;
+        return;
     }
-    XBT_DEBUG("Exiting");
+    if (batch_ == nullptr) {
+        batch_ = PoolNew<TaskBatch>();
+        batch_->tasks.reserve(batch_size_);
+    }
+    batch_->tasks.push_back(req);
+    if (batch_->tasks.size() == batch_size_) {
+        FlushBatch();
+    }
+}
+
+void Client::FlushBatch() {
+    if (batch_ == nullptr) {
+        return;
+    }
+    auto* msg = PoolNew<Message>(MessageType::TASK_BATCH, batch_, mb_);
+    master_mb_->put(msg, kMessagePayloadSize * batch_->tasks.size());
+    stats_.task_messages++;
+    batch_ = nullptr;
 }
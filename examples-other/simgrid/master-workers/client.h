@@ -6,16 +6,43 @@ namespace simgrid::xbt::random {
 class XbtRandom;
 }
 
+class TraceReader;
+
+struct ClientStats {
+    // number of TASK_REQUEST and TASK_BATCH messages sent to master
+    uint64_t task_messages = 0;
+};
+
 class Client {
 public:
-    explicit Client(std::string name, uint32_t task_count, sg4::Mailbox* master_mb,
-                    simgrid::xbt::random::XbtRandom* random);
+    // Tasks are submitted in TASK_BATCH messages of batch_size tasks if batch_size > 1. With
+    // dataset_count > 0 task inputs are randomly chosen from dataset_count shared datasets.
+    explicit Client(std::string name, uint32_t task_count, uint32_t batch_size,
+                    sg4::Mailbox* master_mb, simgrid::xbt::random::XbtRandom* random,
+                    ClientStats& stats, uint32_t dataset_count = 0);
+
+    // Submits the first task_count tasks of the trace at their arrival times. The trace is read in
+    // windows of window_size records, so memory used by client does not depend on the trace length.
+    // Tasks arriving at the same time are submitted in TASK_BATCH messages of up to batch_size tasks.
+    explicit Client(std::string name, TraceReader* trace, uint32_t task_count, uint32_t window_size,
+                    uint32_t batch_size, sg4::Mailbox* master_mb, ClientStats& stats);
 
     void operator()();
 
 private:
+    void GenerateTasks();
+    void ReplayTrace();
+    void Submit(TaskRequest* req);
+    void FlushBatch();
+
     uint32_t task_count_ = 0;
+    uint32_t batch_size_ = 1;
+    uint32_t dataset_count_ = 0;
+    uint32_t window_size_ = 0;
     sg4::Mailbox* mb_ = nullptr;
     sg4::Mailbox* master_mb_ = nullptr;
     simgrid::xbt::random::XbtRandom* random_ = nullptr;
+    TraceReader* trace_ = nullptr;
+    TaskBatch* batch_ = nullptr;
+    ClientStats& stats_;
 };
@@ -2,15 +2,55 @@
 
 #include <simgrid/forward.h>
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 static inline constexpr int kSchedulePeriod = 10;
 static inline constexpr int kReportStatusPeriod = 100;
+// Tolerance of comparing the clock with the time of the next periodic activity: the timeout of
+// wait_any_for() is a difference of doubles, so it can expire slightly before that time
+static inline constexpr double kPeriodicTimeTolerance = 1e-9;
 static inline constexpr int kMessagePayloadSize = 10;
 
 namespace sg4 = simgrid::s4u;
 
-enum MessageType { START, WORKER_REGISTER, TASK_REQUEST, TASK_COMPLETED, STOP };
+enum MessageType {
+    START,
+    WORKER_REGISTER,
+    TASK_REQUEST,
+    TASK_BATCH,
+    TASK_COMPLETED,
+    TASK_COMPLETED_BATCH,
+    TASK_PULL,
+    STOP
+};
+
+// How tasks are dispatched to workers:
+// - PUSH: master assigns tasks to idle workers in periodic scheduling rounds
+// - PULL: in addition, a worker requests new tasks as soon as a task completes and its resources
+//   are freed, and master immediately assigns it queued tasks that fit
+enum class DispatchMode { PUSH, PULL };
+
+// Events recorded with --event-trace, id0 is task id (if not stated otherwise):
+// - SCHEDULE_ROUND: id0 is the number of assigned tasks, id1 is the round wall time in us
+// - ACTIVITY_COMPLETED: id1 is ActivityKind of the completed worker activity
+// - CACHE_HIT: id1 is the input dataset id
+enum class MasterWorkersEvent : uint16_t {
+    TASK_SUBMITTED,
+    SCHEDULE_ROUND,
+    TASK_ASSIGNED,
+    TASK_COMPLETED,
+    TASK_RECEIVED,
+    ACTIVITY_COMPLETED,
+    CACHE_HIT
+};
+
+// Event names in MasterWorkersEvent order
+inline std::vector<std::string> MasterWorkersEventNames() {
+    return {"task_submitted", "schedule_round",     "task_assigned", "task_completed",
+            "task_received",  "activity_completed", "cache_hit"};
+}
 
 struct Message {
     MessageType type;
@@ -31,11 +71,18 @@ struct WorkerRegister {
 
 struct TaskRequest {
     int id;
-    int flops;
+    double flops;
     double memory;
     int cores;
     double input_size;
     double output_size;
+    // input dataset shared by tasks, which can be cached on workers, -1 if the input is unique
+    int dataset_id = -1;
+};
+
+// Multiple task requests sent in a single message
+struct TaskBatch {
+    std::vector<TaskRequest*> tasks;
 };
 
 enum TaskState { NEW, ASSIGNED, DOWNLOADING, READING, RUNNING, WRITING, UPLOADING, COMPLETED };
@@ -48,3 +95,15 @@ struct TaskInfo {
 struct TaskCompleted {
     int task_id;
 };
+
+// Multiple task completions reported by sub-master to master in a single message
+struct TaskCompletedBatch {
+    std::vector<int> task_ids;
+};
+
+// Task completion combined with request for new tasks, used in PULL dispatch mode. The freed
+// resources are not reported, master uses its own view of worker resources, which also accounts the
+// tasks sent to worker but not received yet.
+struct TaskPull {
+    int completed_task_id;
+};
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+
+# Converts VM traces used by DSLab IaaS examples (see examples/iaas-traces) into task traces for
+# master-workers --trace. Each VM becomes a task arriving at the VM start time, which requires the VM
+# cores and memory and computes for the VM lifetime at --speed flops/s. VM traces have no data, so
+# all tasks get --input-size and --output-size. Task traces in CSV format can also be converted to
+# the binary format, which is more compact and faster to read.
+#
+# The output format is binary if the output file name ends with .bin and CSV otherwise.
+#
+# Examples:
+#
+#   ./convert-trace.py --output azure.bin azure --vm-types vm_types.csv \
+#       --vm-instances vm_instances.csv --simulation-length 86400
+#   ./convert-trace.py --output huawei.csv huawei --events Huawei-East-1.csv
+#   ./convert-trace.py --output huawei.bin csv --input huawei.csv
+
+import argparse
+import csv
+import math
+import struct
+import sys
+
+
+CSV_HEADER = ["arrival_time", "flops", "memory", "cores", "input_size", "output_size"]
+
+# must match TraceRecord and kTraceMagic in trace.h
+BINARY_MAGIC = b"MWTRACE1"
+BINARY_HEADER = struct.Struct("<8sQ")
+BINARY_RECORD = struct.Struct("<dddddii")
+
+SECONDS_PER_DAY = 86400.
+
+
+class Task:
+    def __init__(self, arrival_time, lifetime, memory, cores, dataset_id=-1):
+        self.arrival_time = arrival_time
+        self.lifetime = lifetime
+        self.memory = memory
+        self.cores = cores
+        self.dataset_id = dataset_id
+
+
+def read_azure(args):
+    """Reads Azure Packing 2020 trace, the same way as AzureDatasetReader."""
+    vm_types = {}
+    with open(args.vm_types, newline="") as f:
+        for row in csv.DictReader(f):
+            vm_types[row["vmTypeId"]] = (float(row["core"]), float(row["memory"]))
+    with open(args.vm_instances, newline="") as f:
+        for row in csv.DictReader(f):
+            start_time = float(row["starttime"])
+            if start_time < 0:
+                continue
+            start_time *= SECONDS_PER_DAY
+            if start_time > args.simulation_length:
+                continue
+            end_time = row["endtime"]
+            end_time = float(end_time) * SECONDS_PER_DAY if end_time else args.simulation_length
+            core, memory = vm_types[row["vmTypeId"]]
+            yield Task(start_time, end_time - start_time, memory * args.host_memory,
+                       math.ceil(core * args.host_cores))
+
+
+def read_huawei(args):
+    """Reads Huawei VM placements trace, the same way as HuaweiDatasetReader."""
+    starts = []
+    end_times = {}
+    with open(args.events, newline="") as f:
+        for row in csv.DictReader(f):
+            time = float(row["time"])
+            if time > args.simulation_length:
+                continue
+            if int(row["type"]) == 0:
+                starts.append((int(row["vmid"]), int(row["cpu"]), float(row["memory"]), time))
+            else:
+                end_times[int(row["vmid"])] = time
+    for vm_id, cpu, memory, time in starts:
+        lifetime = end_times.get(vm_id, args.simulation_length) - time
+        yield Task(time, lifetime, memory * args.memory_scale, cpu)
+
+
+def read_csv(args):
+    with open(args.input, newline="") as f:
+        for row in csv.DictReader(f):
+            yield Task(float(row["arrival_time"]), float(row["flops"]), float(row["memory"]),
+                       int(row["cores"]), int(row.get("dataset_id") or -1)), row
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("--output", required=True, help="Output trace, binary if ends with .bin")
+    ap.add_argument("--speed", type=float, default=1.,
+                    help="Task flops per second of VM lifetime (default 1)")
+    ap.add_argument("--input-size", type=float, default=0., help="Task input size (default 0)")
+    ap.add_argument("--output-size", type=float, default=0., help="Task output size (default 0)")
+    ap.add_argument("--host-cores", type=int, default=8,
+                    help="Host cores, which scale Azure VM types and limit task cores (default 8)")
+    ap.add_argument("--host-memory", type=float, default=4096,
+                    help="Host memory, which scales Azure VM types and limits task memory "
+                         "(default 4096)")
+    ap.add_argument("--max-tasks", type=int, default=0,
+                    help="Maximal number of converted tasks (default 0, i.e. all)")
+    formats = ap.add_subparsers(dest="format", required=True)
+    azure = formats.add_parser("azure", help="Azure Packing 2020 trace")
+    azure.add_argument("--vm-types", required=True)
+    azure.add_argument("--vm-instances", required=True)
+    azure.add_argument("--simulation-length", type=float, default=math.inf,
+                       help="Skip VMs starting later, end time of VMs without end time")
+    huawei = formats.add_parser("huawei", help="Huawei VM placements trace")
+    huawei.add_argument("--events", required=True)
+    huawei.add_argument("--simulation-length", type=float, default=math.inf,
+                        help="Skip events happening later, end time of VMs without end time")
+    huawei.add_argument("--memory-scale", type=float, default=128,
+                        help="Task memory per unit of VM memory (default 128)")
+    task_csv = formats.add_parser("csv", help="master-workers CSV trace")
+    task_csv.add_argument("--input", required=True)
+    args = ap.parse_args()
+
+    if args.format == "csv":
+        # the trace is already in task units, only the format is changed
+        rows = [(task.arrival_time, task.lifetime, task.memory, task.cores,
+                 float(row["input_size"]), float(row["output_size"]), task.dataset_id)
+                for task, row in read_csv(args)]
+    else:
+        reader = read_azure if args.format == "azure" else read_huawei
+        rows = []
+        clamped = 0
+        for task in reader(args):
+            cores = min(max(task.cores, 1), args.host_cores)
+            memory = min(task.memory, args.host_memory)
+            clamped += cores != task.cores or memory != task.memory
+            rows.append((task.arrival_time, task.lifetime * args.speed, memory, cores,
+                         args.input_size, args.output_size, task.dataset_id))
+        if clamped > 0:
+            print(f"{clamped} tasks were limited to host cores and memory", file=sys.stderr)
+    if any(math.isinf(row[1]) for row in rows):
+        sys.exit("VMs without end time require --simulation-length")
+    # client submits tasks in trace order
+    rows.sort(key=lambda row: row[0])
+    if args.max_tasks > 0:
+        rows = rows[:args.max_tasks]
+
+    if args.output.endswith(".bin"):
+        with open(args.output, "wb") as f:
+            f.write(BINARY_HEADER.pack(BINARY_MAGIC, len(rows)))
+            for row in rows:
+                f.write(BINARY_RECORD.pack(row[0], row[1], row[2], row[4], row[5], row[3], row[6]))
+    else:
+        with_datasets = any(row[6] >= 0 for row in rows)
+        with open(args.output, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(CSV_HEADER + (["dataset_id"] if with_datasets else []))
+            for row in rows:
+                writer.writerow(list(row[:6]) + ([row[6]] if with_datasets else []))
+    print(f"Wrote {len(rows)} tasks to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+
+# Compares periodic push scheduling with pull-based dispatch (workers request tasks as soon as a task
+# completes) for several host and task counts and prints simulated makespan and throughput, run time
+# and master time (wall time spent in scheduling and dispatching) of each run.
+#
+# Example (from build directory):
+#
+#   ../../master-workers/dispatch-benchmark.py --hosts 100,1000 --tasks 10000,100000 -- --master-mode event-driven
+
+import argparse
+import itertools
+import json
+import re
+import subprocess
+import sys
+
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+MASTER_TIME_REGEX = re.compile(r"^Master time: ([\d\.]+)s$", re.MULTILINE)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--binary", default="bin/master-workers")
+    ap.add_argument("--hosts", default="100,1000", help="Comma-separated list of host counts")
+    ap.add_argument("--tasks", default="10000,100000", help="Comma-separated list of task counts")
+    ap.add_argument("--dispatch", default="push,pull", help="Comma-separated list of dispatch modes")
+    ap.add_argument("extra_args", nargs="*", help="Arguments passed to master-workers (after --)")
+    args = ap.parse_args()
+
+    header = ["hosts", "tasks", "dispatch", "makespan, s", "tasks/s (sim)", "run time, s",
+              "master time, s"]
+    rows = []
+    for hosts, tasks in itertools.product(args.hosts.split(","), args.tasks.split(",")):
+        for dispatch in args.dispatch.split(","):
+            command = [args.binary, hosts, tasks, "--dispatch", dispatch,
+                       "--log=root.thres:critical"] + args.extra_args
+            print(f"Running {hosts} hosts, {tasks} tasks with {dispatch} dispatch", file=sys.stderr)
+            proc = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                  text=True)
+            m = RESULT_REGEX.search(proc.stdout)
+            master_time = MASTER_TIME_REGEX.search(proc.stdout)
+            if proc.returncode != 0 or m is None or master_time is None:
+                rows.append([hosts, tasks, dispatch, "failed", "-", "-", "-"])
+                continue
+            result = json.loads(m.group(1))
+            makespan = result["sim_time"]
+            rows.append([hosts, tasks, dispatch, f"{makespan:.2f}",
+                         f"{int(tasks) / makespan:.2f}" if makespan > 0 else "-",
+                         f"{result['run_time']:.3f}", master_time.group(1)])
+
+    widths = [max(len(x) for x in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(x.ljust(w) for x, w in zip(row, widths)).rstrip())
+
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <iostream>
+#include <optional>
 #include <unordered_set>
 
+#include <argparse/argparse.hpp>
 #include <simgrid/s4u.hpp>
 #include <xbt/random.hpp>
 
@@ -7,23 +11,211 @@
 #include "master.h"
 #include "worker.h"
 #include "client.h"
+#include "trace.h"
+#include "context_options.h"
+#include "event_trace.h"
+#include "instrumentation.h"
+#include "run_stats.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(main, "Main");
 
+using dslab::simgrid_examples::ContextArguments;
+using dslab::simgrid_examples::EventTracer;
+using dslab::simgrid_examples::GetPeakRss;
+using dslab::simgrid_examples::Instrumentation;
+using dslab::simgrid_examples::RunStats;
+using dslab::simgrid_examples::ToSeconds;
+
+namespace {
+
+struct WorkerSpec {
+    sg4::Host* host;
+    double speed;
+    int cores;
+    double memory;
+};
+
+}  // namespace
+
 int main(int argc, char* argv[]) {
+    RunStats run_stats("master-workers");
+    // --context-factory, --nthreads and --stack-size are passed to the engine as --cfg options
+    ContextArguments context_args(argc, argv);
+    argc = *context_args.Argc();
+    argv = context_args.Argv();
     sg4::Engine e(&argc, argv);
     // disabling cross-traffic significantly improves simulation speed for large cases
     sg4::Engine::set_config("network/crosstraffic:0");
-    simgrid::xbt::random::XbtRandom random(123);
 
-    xbt_assert(argc == 3, "Usage: %s HOST_COUNT TASK_COUNT", argv[0]);
-    uint32_t host_count = std::stoi(argv[1]);
-    uint32_t task_count = std::stoi(argv[2]);
+    argparse::ArgumentParser parser("master-workers");
+    auto str_to_uint = [](const std::string& value) {
+        return static_cast<uint32_t>(std::stoul(value));
+    };
+    parser.add_argument("host_count").help("Number of hosts").action(str_to_uint);
+    parser.add_argument("task_count")
+        .help("Number of tasks (with --trace, maximal number of tasks taken from the trace, 0 for "
+              "all)")
+        .action(str_to_uint);
+    parser.add_argument("--platform")
+        .help("Network zone used for platform: full (full routing) or star (linear routing)")
+        .nargs(1)
+        .default_value(std::string("full"));
+    parser.add_argument("--master-mode")
+        .help("Master main loop implementation: blocking, nonblocking or event-driven")
+        .nargs(1)
+        .default_value(std::string("blocking"));
+    parser.add_argument("--sort-workers")
+        .help("Sort all idle workers for each task instead of using worker index")
+        .default_value(false)
+        .implicit_value(true);
+    parser.add_argument("--batch-size")
+        .help("Number of tasks per client message, values > 1 also enable sending all tasks "
+              "assigned to a worker in a scheduling round as a single message")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(static_cast<uint32_t>(1));
+    parser.add_argument("--dispatch")
+        .help("Task dispatch: push (periodic scheduling rounds only) or pull (workers also request "
+              "tasks as soon as a task completes)")
+        .nargs(1)
+        .default_value(std::string("push"));
+    parser.add_argument("--sub-masters")
+        .help("Number of sub-master actors, each managing a part of workers and receiving tasks "
+              "from master (0, default, means that master manages all workers)")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(static_cast<uint32_t>(0));
+    parser.add_argument("--datasets")
+        .help("Number of input datasets shared by tasks, which are cached on workers (0, default, "
+              "means that each task has unique input)")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(static_cast<uint32_t>(0));
+    parser.add_argument("--prefer-locality")
+        .help("Assign a task to the worker which got its input dataset last, if it fits the task")
+        .default_value(false)
+        .implicit_value(true);
+    parser.add_argument("--disk-size")
+        .help("Size of worker disks, which limits the input cache")
+        .nargs(1)
+        .default_value(std::string("1000GiB"));
+    parser.add_argument("--trace")
+        .help("Submit tasks from CSV or binary trace at their arrival times instead of generating "
+              "them")
+        .nargs(1)
+        .default_value(std::string());
+    parser.add_argument("--trace-window")
+        .help("Number of trace records read by client at once")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(static_cast<uint32_t>(1024));
+    parser.add_argument("--seed")
+        .help("Seed used to generate worker hosts and tasks")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(static_cast<uint32_t>(123));
+    parser.add_argument("--event-trace")
+        .help("Record binary event trace to the given file, see decode-event-trace.py")
+        .nargs(1)
+        .default_value(std::string());
+    parser.add_argument("--event-trace-ring")
+        .help("Keep only the given number of last events in the event trace (0, default, keeps "
+              "all events)")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(static_cast<uint32_t>(0));
+    parser.add_argument("--instrument")
+        .help("Collect activity, solver round and context switch counters and print a summary")
+        .default_value(false)
+        .implicit_value(true);
 
-    // build platform and create actors
-    auto* zone = sg4::create_full_zone("net");
-    sg4::Mailbox* master_mailbox = sg4::Mailbox::by_name("master");
-    double scheduling_time = 0;
+    uint32_t host_count = 0, task_count = 0, batch_size = 1, sub_master_count = 0,
+             dataset_count = 0, trace_window = 1024, event_trace_ring = 0, seed = 123;
+    bool sort_workers = false, prefer_locality = false, instrument = false;
+    std::string disk_size, trace_path, event_trace_path;
+    MasterMode master_mode = MasterMode::BLOCKING;
+    DispatchMode dispatch_mode = DispatchMode::PUSH;
+    std::string platform;
+    try {
+        parser.parse_args(argc, argv);
+        host_count = parser.get<uint32_t>("host_count");
+        task_count = parser.get<uint32_t>("task_count");
+        sort_workers = parser.get<bool>("--sort-workers");
+        batch_size = parser.get<uint32_t>("--batch-size");
+        sub_master_count = parser.get<uint32_t>("--sub-masters");
+        dataset_count = parser.get<uint32_t>("--datasets");
+        prefer_locality = parser.get<bool>("--prefer-locality");
+        disk_size = parser.get<std::string>("--disk-size");
+        trace_path = parser.get<std::string>("--trace");
+        trace_window = parser.get<uint32_t>("--trace-window");
+        seed = parser.get<uint32_t>("--seed");
+        instrument = parser.get<bool>("--instrument");
+        event_trace_path = parser.get<std::string>("--event-trace");
+        event_trace_ring = parser.get<uint32_t>("--event-trace-ring");
+        auto mode = parser.get<std::string>("--master-mode");
+        if (mode == "blocking") {
+            master_mode = MasterMode::BLOCKING;
+        } else if (mode == "nonblocking") {
+            master_mode = MasterMode::NONBLOCKING;
+        } else if (mode == "event-driven") {
+            master_mode = MasterMode::EVENT_DRIVEN;
+        } else {
+            throw std::runtime_error("unknown master mode: " + mode);
+        }
+        auto dispatch = parser.get<std::string>("--dispatch");
+        if (dispatch == "push") {
+            dispatch_mode = DispatchMode::PUSH;
+        } else if (dispatch == "pull") {
+            dispatch_mode = DispatchMode::PULL;
+        } else {
+            throw std::runtime_error("unknown dispatch mode: " + dispatch);
+        }
+        platform = parser.get<std::string>("--platform");
+        if (platform != "full" && platform != "star") {
+            throw std::runtime_error("unknown platform: " + platform);
+        }
+    } catch (const std::runtime_error& re) {
+        std::cerr << "Argument parse error: " << re.what() << "\n";
+        std::cerr << parser << "\n";
+        std::exit(1);
+    }
+
+    xbt_assert(host_count > 0, "HOST_COUNT should be positive");
+    xbt_assert(sub_master_count <= host_count, "--sub-masters should not exceed HOST_COUNT");
+    xbt_assert(trace_window > 0, "--trace-window should be positive");
+    std::optional<TraceReader> trace;
+    if (!trace_path.empty()) {
+        trace.emplace(trace_path);
+        uint64_t record_count = trace->GetRecordCount();
+        if (task_count == 0 || task_count > record_count) {
+            task_count = static_cast<uint32_t>(record_count);
+        }
+        printf("Trace: %lu records, %u tasks used\n", record_count, task_count);
+    }
+    xbt_assert(task_count > 0, "TASK_COUNT should be positive");
+    std::optional<Instrumentation> instrumentation;
+    if (instrument) {
+        instrumentation.emplace();
+    }
+    std::optional<EventTracer> event_tracer;
+    if (!event_trace_path.empty()) {
+        event_tracer.emplace(event_trace_path, MasterWorkersEventNames(), event_trace_ring);
+    }
+    simgrid::xbt::random::XbtRandom random(seed);
+
+    // build platform
+    auto setup_start = std::chrono::steady_clock::now();
+    auto* zone = platform == "star" ? sg4::create_star_zone("net") : sg4::create_full_zone("net");
+    // single backbone link is used for inter-host communication
+    const sg4::Link* link =
+        zone->create_link("backbone", "10GBps")
+            ->set_sharing_policy(sg4::Link::SharingPolicy::FATPIPE)  // transfers use full bandwidth
+            //->set_sharing_policy(sg4::Link::SharingPolicy::SHARED) // transfers share bandwidth
+            ->set_latency("10us")
+            ->seal();
+    sg4::LinkInRoute backbone(link);
+    std::vector<WorkerSpec> worker_specs;
+    worker_specs.reserve(host_count);
     for (uint32_t i = 0; i < host_count; i++) {
         std::string hostname = "host-" + std::to_string(i);
         double speed = random.uniform_int(1, 10);
@@ -32,7 +224,7 @@ int main(int argc, char* argv[]) {
         auto host = zone->create_host(hostname, speed);
         host->set_core_count(cores);
         auto disk = host->create_disk(hostname + "-fs", "1GBps", "1GBps");
-        disk->set_property("size", "1000GiB");
+        disk->set_property("size", disk_size);
         disk->set_property("mount", "/");
         // loopback link is used for intra-host communications
         const sg4::Link* loopback = zone->create_link(hostname + "-loopback", "100GBps")
@@ -41,43 +233,131 @@ int main(int argc, char* argv[]) {
                                         ->seal();
         zone->add_route(host->get_netpoint(), host->get_netpoint(), nullptr, nullptr,
                         {sg4::LinkInRoute(loopback)});
-        if (i == 0) {
-            sg4::Actor::create("master", host, Master("master", task_count, true, scheduling_time));
-            sg4::Actor::create("client", host,
-                               Client("client", task_count, master_mailbox, &random));
+        if (platform == "star") {
+            // routes in star zone go to/from the zone center, master route is empty so that the
+            // route between master and worker consists of a single backbone link
+            if (i == 0) {
+                zone->add_route(host->get_netpoint(), nullptr, nullptr, nullptr, {});
+            } else {
+                zone->add_route(host->get_netpoint(), nullptr, nullptr, nullptr, {backbone});
+            }
+        } else if (i > 0) {
+            zone->add_route(worker_specs.front().host->get_netpoint(), host->get_netpoint(),
+                            nullptr, nullptr, {backbone});
+            // worker i exchanges data with sub-master i % K running on host-(i % K)
+            if (sub_master_count > 0 && i % sub_master_count != 0 && i >= sub_master_count) {
+                zone->add_route(worker_specs[i % sub_master_count].host->get_netpoint(),
+                                host->get_netpoint(), nullptr, nullptr, {backbone});
+            }
         }
-        std::string worker_name = "worker-" + std::to_string(i);
-        sg4::Actor::create(worker_name, host,
-                           Worker(worker_name, speed, cores, memory, true, master_mailbox,
-                                  e.host_by_name("host-0")));
-    }
-    // single backbone link is used for inter-host communication
-    const sg4::Link* link =
-        zone->create_link("backbone", "10GBps")
-            ->set_sharing_policy(sg4::Link::SharingPolicy::FATPIPE)  // transfers use full bandwidth
-            //->set_sharing_policy(sg4::Link::SharingPolicy::SHARED) // transfers share bandwidth
-            ->set_latency("10us")
-            ->seal();
-    sg4::LinkInRoute backbone(link);
-    auto master_host = e.host_by_name("host-0");
-    for (uint32_t i = 1; i < host_count; i++) {
-        std::string host = "host-" + std::to_string(i);
-        zone->add_route(master_host->get_netpoint(), e.host_by_name(host)->get_netpoint(), nullptr,
-                        nullptr, {backbone});
+        worker_specs.push_back(WorkerSpec{host, speed, cores, memory});
     }
     zone->seal();
+    auto platform_time = ToSeconds(std::chrono::steady_clock::now() - setup_start);
+
+    // create actors
+    sg4::Mailbox* master_mailbox = sg4::Mailbox::by_name("master");
+    auto* master_host = worker_specs.front().host;
+    MasterStats master_stats;
+    // master sends tasks to sub-masters in a single message per scheduling round
+    sg4::Actor::create("master", master_host,
+                       Master("master", task_count, master_mode, sort_workers,
+                              batch_size > 1 || sub_master_count > 0, dispatch_mode, master_stats,
+                              nullptr, 0, prefer_locality));
+    ClientStats client_stats;
+    if (trace) {
+        sg4::Actor::create("client", master_host,
+                           Client("client", &*trace, task_count, trace_window, batch_size,
+                                  master_mailbox, client_stats));
+    } else {
+        sg4::Actor::create("client", master_host,
+                           Client("client", task_count, batch_size, master_mailbox, &random,
+                                  client_stats, dataset_count));
+    }
+    // sub-master k runs on host-k and manages workers k, k + K, k + 2K, ...
+    std::vector<sg4::Mailbox*> sub_master_mailboxes;
+    std::vector<MasterStats> sub_master_stats(sub_master_count);
+    for (uint32_t k = 0; k < sub_master_count; k++) {
+        std::string name = "sub-master-" + std::to_string(k);
+        sub_master_mailboxes.push_back(sg4::Mailbox::by_name(name));
+        uint32_t worker_count = (host_count - k + sub_master_count - 1) / sub_master_count;
+        sg4::Actor::create(name, worker_specs[k].host,
+                           Master(name, task_count, master_mode, sort_workers, batch_size > 1,
+                                  dispatch_mode, sub_master_stats[k], master_mailbox,
+                                  worker_count, prefer_locality));
+    }
+    std::vector<CacheStats> cache_stats(host_count);
+    for (uint32_t i = 0; i < host_count; i++) {
+        const auto& spec = worker_specs[i];
+        std::string worker_name = "worker-" + std::to_string(i);
+        auto* worker_master_mb =
+            sub_master_count > 0 ? sub_master_mailboxes[i % sub_master_count] : master_mailbox;
+        auto* worker_master_host =
+            sub_master_count > 0 ? worker_specs[i % sub_master_count].host : master_host;
+        sg4::Actor::create(worker_name, spec.host,
+                           Worker(worker_name, spec.speed, spec.cores, spec.memory, true,
+                                  worker_master_mb, worker_master_host, dispatch_mode,
+                                  &cache_stats[i]));
+    }
+
+    run_stats.SetupDone();
 
     // run simulation
-    auto start = std::chrono::steady_clock::now();
+    if (instrumentation) {
+        instrumentation->RunStarted();
+    }
     e.run();
-    auto stop = std::chrono::steady_clock::now();
-    auto duration =
-        static_cast<double>(
-            std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count()) /
-        1000;
+    run_stats.RunDone(e.get_clock(), task_count);
+    if (instrumentation) {
+        instrumentation->RunDone();
+    }
+    auto duration = run_stats.GetRunTime();
     printf("Processed %d tasks on %d hosts in %.2fs (%.2f tasks/s)\n", task_count, host_count,
            e.get_clock(), task_count / e.get_clock());
+    printf("Platform construction time: %.2fs\n", platform_time);
     printf("Elapsed time: %.2fs\n", duration);
-    printf("Scheduling time: %.2fs\n", scheduling_time);
+    printf("Scheduling time: %.2fs\n", master_stats.scheduling_time);
+    if (dispatch_mode == DispatchMode::PULL) {
+        printf("Pull dispatch time: %.2fs (%lu pull requests)\n", master_stats.dispatch_time,
+               master_stats.pull_requests);
+    }
+    printf("Master time: %.2fs\n", master_stats.scheduling_time + master_stats.dispatch_time);
+    printf("Task messages: %lu from client, %lu from master\n", client_stats.task_messages,
+           master_stats.task_messages);
+    if (sub_master_count > 0) {
+        double total_time = 0, max_time = 0;
+        uint64_t task_messages = 0;
+        for (const auto& stats : sub_master_stats) {
+            double time = stats.scheduling_time + stats.dispatch_time;
+            total_time += time;
+            max_time = std::max(max_time, time);
+            task_messages += stats.task_messages;
+        }
+        printf("Sub-master time: %.2fs total, %.2fs max\n", total_time, max_time);
+        printf("Task messages from sub-masters: %lu\n", task_messages);
+    }
+    CacheStats total;
+    for (const auto& stats : cache_stats) {
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.bytes_saved += stats.bytes_saved;
+    }
+    // the cache is used only by tasks with datasets, which are generated or come from trace
+    if (uint64_t lookups = total.hits + total.misses; lookups > 0) {
+        printf("Input cache: %lu hits, %lu misses (%.1f%% hit rate), %.2f GB of downloads saved\n",
+               total.hits, total.misses, 100. * total.hits / lookups, total.bytes_saved / 1e9);
+    }
     printf("Simulation speedup: %.2f\n", e.get_clock() / duration);
+    printf("Peak RSS: %ld KB after setup, %ld KB total\n", run_stats.GetSetupRss(),
+           GetPeakRss());
+    if (instrumentation) {
+        instrumentation->Print();
+    }
+    if (event_tracer) {
+        event_tracer->Close();
+        printf("Event trace: %lu events written to %s (%lu dropped)\n",
+               event_tracer->GetWrittenCount(), event_trace_path.c_str(),
+               event_tracer->GetDroppedCount());
+    }
+    run_stats.Print();
 }
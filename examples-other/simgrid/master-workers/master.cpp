@@ -1,28 +1,53 @@
 #include "master.h"
 
-#include <unordered_set>
+#include <algorithm>
 
 #include <simgrid/s4u.hpp>
 #include <xbt/random.hpp>
 
+#include "event_trace.h"
+#include "object_pool.h"
+
+using dslab::simgrid_examples::PoolDelete;
+using dslab::simgrid_examples::PoolNew;
+using dslab::simgrid_examples::RecordEvent;
+
 XBT_LOG_NEW_DEFAULT_CATEGORY(master, "Master");
 
-Master::Master(std::string name, uint32_t task_count, bool blocking, double& scheduling_time)
-    : task_count_(task_count), blocking_(blocking), scheduling_time_(scheduling_time) {
+Master::Master(std::string name, uint32_t task_count, MasterMode mode, bool sort_workers,
+               bool batch_tasks, DispatchMode dispatch_mode, MasterStats& stats,
+               sg4::Mailbox* parent_mb, uint32_t worker_count, bool prefer_locality)
+    : task_count_(task_count),
+      mode_(mode),
+      sort_workers_(sort_workers),
+      batch_tasks_(batch_tasks),
+      dispatch_mode_(dispatch_mode),
+      // sub-master receives only a part of the tasks, so its table grows with the tasks it holds
+      tasks_(parent_mb == nullptr ? task_count : 0),
+      stats_(stats),
+      parent_mb_(parent_mb),
+      worker_count_(worker_count),
+      prefer_locality_(prefer_locality) {
     mb_ = sg4::Mailbox::by_name(name);
 }
 
 void Master::operator()() {
     mb_->set_receiver(sg4::Actor::self());
-    if (blocking_) {
-        BlockingImpl();
-    } else {
-        NonblockingImpl();
+    switch (mode_) {
+        case MasterMode::BLOCKING:
+            BlockingImpl();
+            break;
+        case MasterMode::NONBLOCKING:
+            NonblockingImpl();
+            break;
+        case MasterMode::EVENT_DRIVEN:
+            EventDrivenImpl();
+            break;
     }
     ReportStatus();
     // stop all workers
     for (auto& [worker_id, worker] : workers_) {
-        auto* msg = new Message(MessageType::STOP, nullptr, mb_);
+        auto* msg = PoolNew<Message>(MessageType::STOP, nullptr, mb_);
         worker->mb->put(msg, kMessagePayloadSize);
     }
     XBT_DEBUG("Exiting");
@@ -32,37 +57,11 @@ void Master::operator()() {
 // - uses blocking get() to receive incoming messages
 // - as a consequence, periodic activities can be delayed
 void Master::BlockingImpl() {
-    while (completed_tasks_.size() != task_count_) {
+    while (IsRunning()) {
         // receive messages from client and workers
-        Message* msg = mb_->get<Message>();
-        switch (msg->type) {
-            case MessageType::WORKER_REGISTER: {
-                OnWorkerRegister(static_cast<WorkerRegister*>(msg->data), msg->from);
-                break;
-            }
-            case MessageType::TASK_REQUEST: {
-                OnTaskRequest(static_cast<TaskRequest*>(msg->data));
-                break;
-            }
-            case MessageType::TASK_COMPLETED: {
-                OnTaskCompleted(static_cast<TaskCompleted*>(msg->data), msg->from);
-                break;
-            }
-            default:
-                std::abort();
-        }
-        delete msg;
+        OnMessage(mb_->get<Message>());
         // execute periodic activities
-        double now = sg4::Engine::get_clock();
-        if (now >= next_report_time_ || unassigned_tasks_.size() == task_count_) {
-            ReportStatus();
-            next_report_time_ = now + kReportStatusPeriod;
-        }
-        if (now >= next_schedule_time_ || unassigned_tasks_.size() == task_count_ ||
-            (!completed_tasks_.empty() && assigned_tasks_.empty())) {
-            ScheduleTasks();
-            next_schedule_time_ = now + kSchedulePeriod;
-        }
+        RunPeriodicActivities();
     }
 }
 
@@ -72,42 +71,17 @@ void Master::BlockingImpl() {
 void Master::NonblockingImpl() {
     Message* msg;
     auto comm = mb_->get_async<Message>(&msg);
-    while (completed_tasks_.size() != task_count_) {
+    while (IsRunning()) {
         bool comm_completed = false;
         // receive messages from client and workers
         if (comm->test()) {  // cannot use wait_for(timeout) since it breaks sending activities on
                              // worker side!
-            switch (msg->type) {
-                case MessageType::WORKER_REGISTER: {
-                    OnWorkerRegister(static_cast<WorkerRegister*>(msg->data), msg->from);
-                    break;
-                }
-                case MessageType::TASK_REQUEST: {
-                    OnTaskRequest(static_cast<TaskRequest*>(msg->data));
-                    break;
-                }
-                case MessageType::TASK_COMPLETED: {
-                    OnTaskCompleted(static_cast<TaskCompleted*>(msg->data), msg->from);
-                    break;
-                }
-                default:
-                    std::abort();
-            }
-            delete msg;
+            OnMessage(msg);
             comm_completed = true;
             comm = mb_->get_async<Message>(&msg);
         }
         // periodic activities
-        double now = sg4::Engine::get_clock();
-        if (now >= next_report_time_ || unassigned_tasks_.size() == task_count_) {
-            ReportStatus();
-            next_report_time_ = now + kReportStatusPeriod;
-        }
-        if (now >= next_schedule_time_ || unassigned_tasks_.size() == task_count_ ||
-            (!completed_tasks_.empty() && assigned_tasks_.empty())) {
-            ScheduleTasks();
-            next_schedule_time_ = now + kSchedulePeriod;
-        }
+        RunPeriodicActivities();
         // sleep
         if (!comm_completed) {
             sg4::this_actor::sleep_for(0.1);
@@ -115,104 +89,429 @@ void Master::NonblockingImpl() {
     }
 }
 
+// Event-driven implementation of main loop
+// - waits for incoming message with timeout set to the time of the next periodic activity
+// - wait_any_for() does not cancel the receive activity on timeout, unlike Comm::wait_for()
+// - periodic activities are not delayed and the actor wakes up only when there is work to do
+void Master::EventDrivenImpl() {
+    Message* msg;
+    std::vector<sg4::ActivityPtr> activities = {mb_->get_async<Message>(&msg)};
+    while (IsRunning()) {
+        double timeout =
+            std::min(next_schedule_time_, next_report_time_) - sg4::Engine::get_clock();
+        // receive messages from client and workers
+        if (sg4::Activity::wait_any_for(activities, timeout) == 0) {
+            OnMessage(msg);
+            activities[0] = mb_->get_async<Message>(&msg);
+        }
+        // periodic activities
+        RunPeriodicActivities();
+    }
+}
+
+void Master::OnMessage(Message* msg) {
+    switch (msg->type) {
+        case MessageType::WORKER_REGISTER: {
+            OnWorkerRegister(static_cast<WorkerRegister*>(msg->data), msg->from);
+            break;
+        }
+        case MessageType::TASK_REQUEST: {
+            OnTaskRequest(static_cast<TaskRequest*>(msg->data));
+            break;
+        }
+        case MessageType::TASK_BATCH: {
+            OnTaskBatch(static_cast<TaskBatch*>(msg->data));
+            break;
+        }
+        case MessageType::TASK_COMPLETED: {
+            OnTaskCompleted(static_cast<TaskCompleted*>(msg->data), msg->from);
+            break;
+        }
+        case MessageType::TASK_PULL: {
+            OnTaskPull(static_cast<TaskPull*>(msg->data), msg->from);
+            break;
+        }
+        case MessageType::TASK_COMPLETED_BATCH: {
+            OnTaskCompletedBatch(static_cast<TaskCompletedBatch*>(msg->data), msg->from);
+            break;
+        }
+        case MessageType::STOP: {
+            xbt_assert(parent_mb_ != nullptr, "Only sub-master can be stopped");
+            stopped_ = true;
+            break;
+        }
+        default:
+            std::abort();
+    }
+    PoolDelete(msg);
+}
+
+bool Master::IsRunning() const {
+    return parent_mb_ == nullptr ? completed_task_count_ != task_count_ : !stopped_;
+}
+
+void Master::RunPeriodicActivities() {
+    double now = sg4::Engine::get_clock();
+    bool all_submitted = parent_mb_ == nullptr && unassigned_tasks_.size == task_count_;
+    if (now + kPeriodicTimeTolerance >= next_report_time_ || all_submitted) {
+        ReportStatus();
+        next_report_time_ = now + kReportStatusPeriod;
+    }
+    // sub-master schedules the tasks as soon as they are received, since they are already sent in
+    // the scheduling rounds of the parent
+    bool scheduled = false;
+    if (now + kPeriodicTimeTolerance >= next_schedule_time_ || all_submitted || has_new_tasks_ ||
+        (completed_task_count_ > 0 && assigned_tasks_.size == 0)) {
+        ScheduleTasks();
+        next_schedule_time_ = now + kSchedulePeriod;
+        has_new_tasks_ = false;
+        scheduled = true;
+    }
+    // completions are reported once per scheduling round, or immediately when there are no queued
+    // tasks left, so that the parent can send more tasks
+    if (completions_ != nullptr && (scheduled || unassigned_tasks_.size == 0)) {
+        ReportCompletions();
+    }
+}
+
 void Master::OnWorkerRegister(WorkerRegister* reg, sg4::Mailbox* worker_mb) {
     XBT_DEBUG("Worker %s", reg->name.c_str());
     WorkerInfo* info =
         new WorkerInfo{reg->name,       WorkerState::ONLINE, reg->speed,        reg->cpus_total,
                        reg->cpus_total, reg->memory_total,   reg->memory_total, worker_mb};
     workers_.emplace(reg->name, info);
-    idle_workers_.push_back(info);
+    PoolDelete(reg);
+    if (sort_workers_) {
+        idle_workers_.push_back(info);
+    } else {
+        idle_workers_index_.insert(info);
+    }
     cpus_total_ += info->cpus_total;
     cpus_available_ += info->cpus_available;
     memory_total_ += info->memory_total;
     memory_available_ += info->memory_available;
+    if (parent_mb_ != nullptr && workers_.size() == worker_count_) {
+        RegisterOnParent();
+    }
+}
+
+void Master::RegisterOnParent() {
+    int speed = 0;
+    for (const auto& [worker_id, worker] : workers_) {
+        speed += worker->speed;
+    }
+    // parent sees the sub-master as a single worker with total resources and average speed
+    auto* reg = PoolNew<WorkerRegister>(mb_->get_name(), speed / static_cast<int>(worker_count_),
+                                        cpus_total_, memory_total_);
+    auto* msg = PoolNew<Message>(MessageType::WORKER_REGISTER, reg, mb_);
+    parent_mb_->put(msg, kMessagePayloadSize);
+}
+
+void Master::ReportCompletions() {
+    auto* msg = PoolNew<Message>(MessageType::TASK_COMPLETED_BATCH, completions_, mb_);
+    parent_mb_->put_init(msg, kMessagePayloadSize * completions_->task_ids.size())->detach();
+    completions_ = nullptr;
 }
 
 void Master::OnTaskRequest(TaskRequest* req) {
     XBT_DEBUG("Task %d", req->id);
-    unassigned_tasks_.emplace(req->id, TaskInfo{req, TaskState::NEW});
+    xbt_assert(req->id >= 0 && static_cast<uint32_t>(req->id) < task_count_,
+               "Task id %d is out of range", req->id);
+    int slot = AllocateSlot(req->id);
+    tasks_[slot].info = TaskInfo{req, TaskState::NEW};
+    InsertTaskOrdered(unassigned_tasks_, slot);
+    has_new_tasks_ = parent_mb_ != nullptr;
+}
+
+void Master::OnTaskBatch(TaskBatch* batch) {
+    for (auto* req : batch->tasks) {
+        OnTaskRequest(req);
+    }
+    PoolDelete(batch);
 }
 
 void Master::OnTaskCompleted(TaskCompleted* msg, sg4::Mailbox* worker_mb) {
     int task_id = msg->task_id;
-    XBT_DEBUG("Completed task %d", task_id);
-    auto& task = assigned_tasks_[task_id];
-    task.state = TaskState::COMPLETED;
-    completed_tasks_.emplace(task_id, task);
-    assigned_tasks_.erase(task_id);
+    PoolDelete(msg);
+    CompleteTask(task_id, workers_[worker_mb->get_name()]);
+}
 
+void Master::OnTaskPull(TaskPull* pull, sg4::Mailbox* worker_mb) {
     auto* worker = workers_[worker_mb->get_name()];
-    if (worker->cpus_available == 0 || worker->memory_available == 0) {
-        idle_workers_.push_back(worker);
+    CompleteTask(pull->completed_task_id, worker);
+    XBT_DEBUG("Pull from %s: %d cores, %f memory available", worker->id.c_str(),
+              worker->cpus_available, worker->memory_available);
+    PoolDelete(pull);
+    stats_.pull_requests++;
+    DispatchToWorker(worker);
+}
+
+void Master::OnTaskCompletedBatch(TaskCompletedBatch* batch, sg4::Mailbox* worker_mb) {
+    auto* worker = workers_[worker_mb->get_name()];
+    for (int task_id : batch->task_ids) {
+        CompleteTask(task_id, worker);
+    }
+    PoolDelete(batch);
+    // the batch frees sub-master resources like a pull request of a worker
+    if (dispatch_mode_ == DispatchMode::PULL) {
+        stats_.pull_requests++;
+        DispatchToWorker(worker);
+    }
+}
+
+void Master::CompleteTask(int task_id, WorkerInfo* worker) {
+    XBT_DEBUG("Completed task %d", task_id);
+    RecordEvent(MasterWorkersEvent::TASK_COMPLETED, task_id);
+    int slot = GetSlot(task_id);
+    auto& task = tasks_[slot].info;
+    RemoveTask(assigned_tasks_, slot);
+    task.state = TaskState::COMPLETED;
+    completed_task_count_++;
+    UpdateWorkerResources(worker, task.req->cores, task.req->memory);
+    if (parent_mb_ != nullptr) {
+        ReleaseSlot(task_id);
+        if (completions_ == nullptr) {
+            completions_ = PoolNew<TaskCompletedBatch>();
+        }
+        completions_->task_ids.push_back(task_id);
     }
-    worker->cpus_available += task.req->cores;
-    worker->memory_available += task.req->memory;
-    cpus_available_ += task.req->cores;
-    memory_available_ += task.req->memory;
 }
 
 void Master::ScheduleTasks() {
-    if (unassigned_tasks_.empty()) {
+    if (unassigned_tasks_.size == 0) {
         return;
     }
     auto start = std::chrono::steady_clock::now();
     XBT_DEBUG(">> Available resources: %d %f", cpus_available_, memory_available_);
-    std::unordered_set<int> assigned;
-    for (auto& [task_id, task] : unassigned_tasks_) {
+    size_t assigned_count = 0;
+    // batches are sent after the scheduling round in order of the first assignment to worker
+    std::vector<std::pair<WorkerInfo*, TaskBatch*>> batches;
+    std::unordered_map<WorkerInfo*, TaskBatch*> worker_batches;
+    for (int slot = unassigned_tasks_.head, next_slot; slot != -1; slot = next_slot) {
+        auto& task = tasks_[slot].info;
+        // the task is relinked to assigned tasks below
+        next_slot = tasks_[slot].next;
         // XBT_DEBUG("- %d: %d flops, %d cores, %d memory", task_id, task.req->flops,
         // task.req->cores, task.req->memory);
-        if (idle_workers_.empty()) {
+        if (!HasIdleWorkers()) {
             break;
         }
         if (cpus_available_ < task.req->cores || memory_available_ < task.req->memory) {
             continue;
         }
-        std::sort(idle_workers_.begin(), idle_workers_.end(), [](WorkerInfo* w1, WorkerInfo* w2) {
-            return std::tie(w1->memory_available, w1->cpus_available, w1->speed, w1->id) >
-                   std::tie(w2->memory_available, w2->cpus_available, w2->speed, w2->id);
-        });
-        for (auto it = idle_workers_.begin(); it != idle_workers_.end();) {
-            WorkerInfo* worker = *it;
-            // XBT_DEBUG("-- w %s: %d %d %d", worker->id.c_str(), worker->cpus_available,
-            // worker->memory_available, worker->speed);
-            if (worker->cpus_available >= task.req->cores &&
-                worker->memory_available >= task.req->memory) {
-                XBT_DEBUG("Assigned %d to %s", task_id, worker->id.c_str());
-                worker->cpus_available -= task.req->cores;
-                worker->memory_available -= task.req->memory;
-                cpus_available_ -= task.req->cores;
-                memory_available_ -= task.req->memory;
-                auto* msg = new Message(MessageType::TASK_REQUEST, task.req, mb_);
-                worker->mb->put_init(msg, kMessagePayloadSize)->detach();
-                assigned.insert(task_id);
-                if (worker->cpus_available == 0 || worker->memory_available == 0) {
-                    std::swap(*it, idle_workers_.back());
-                    idle_workers_.pop_back();
-                }
-                break;
-            } else {
-                it++;
+        WorkerInfo* worker = PickWorkerWithData(task.req);
+        if (worker == nullptr) {
+            worker = sort_workers_ ? PickWorkerSorted(task.req) : PickWorkerIndexed(task.req);
+        }
+        if (worker == nullptr) {
+            continue;
+        }
+        TaskBatch* batch = nullptr;
+        if (batch_tasks_) {
+            auto [it, inserted] = worker_batches.emplace(worker, nullptr);
+            if (inserted) {
+                it->second = PoolNew<TaskBatch>();
+                batches.emplace_back(worker, it->second);
             }
+            batch = it->second;
         }
+        AssignTask(slot, worker, batch);
+        assigned_count++;
     }
-    for (auto const& task_id : assigned) {
-        auto& task = unassigned_tasks_[task_id];
-        task.state = TaskState::ASSIGNED;
-        assigned_tasks_.emplace(task_id, task);
-        unassigned_tasks_.erase(task_id);
+    for (auto [worker, batch] : batches) {
+        SendBatch(worker, batch);
     }
     auto stop = std::chrono::steady_clock::now();
-    double duration =
-        static_cast<double>(
-            std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count()) /
-        1000;
-    XBT_INFO("schedule tasks: assigned %ld tasks in %.2f ms", assigned.size(), duration);
-    scheduling_time_ += duration / 1000;
+    auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+    double duration = static_cast<double>(duration_us) / 1000;
+    XBT_INFO("schedule tasks: assigned %ld tasks in %.2f ms", assigned_count, duration);
+    RecordEvent(MasterWorkersEvent::SCHEDULE_ROUND, assigned_count, duration_us);
+    stats_.scheduling_time += duration / 1000;
+}
+
+void Master::DispatchToWorker(WorkerInfo* worker) {
+    auto start = std::chrono::steady_clock::now();
+    TaskBatch* batch = batch_tasks_ ? PoolNew<TaskBatch>() : nullptr;
+    // tasks are assigned in FIFO order: the scan stops at the first task that does not fit, so a
+    // pull costs O(assigned tasks) instead of a rescan of the queue, the remaining tasks are left
+    // to the next scheduling round or pull
+    for (int slot = unassigned_tasks_.head; slot != -1; slot = unassigned_tasks_.head) {
+        const auto* req = tasks_[slot].info.req;
+        if (worker->cpus_available < req->cores || worker->memory_available < req->memory) {
+            break;
+        }
+        AssignTask(slot, worker, batch);
+    }
+    if (batch != nullptr) {
+        if (batch->tasks.empty()) {
+            PoolDelete(batch);
+        } else {
+            SendBatch(worker, batch);
+        }
+    }
+    stats_.dispatch_time +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Master::AssignTask(int slot, WorkerInfo* worker, TaskBatch* batch) {
+    auto& task = tasks_[slot].info;
+    XBT_DEBUG("Assigned %d to %s", task.req->id, worker->id.c_str());
+    RecordEvent(MasterWorkersEvent::TASK_ASSIGNED, task.req->id);
+    UpdateWorkerResources(worker, -task.req->cores, -task.req->memory);
+    RemoveTask(unassigned_tasks_, slot);
+    task.state = TaskState::ASSIGNED;
+    AppendTask(assigned_tasks_, slot);
+    if (prefer_locality_ && task.req->dataset_id >= 0) {
+        dataset_locations_[task.req->dataset_id] = worker;
+    }
+    if (batch != nullptr) {
+        batch->tasks.push_back(task.req);
+    } else {
+        auto* msg = PoolNew<Message>(MessageType::TASK_REQUEST, task.req, mb_);
+        worker->mb->put_init(msg, kMessagePayloadSize)->detach();
+        stats_.task_messages++;
+    }
+}
+
+void Master::SendBatch(WorkerInfo* worker, TaskBatch* batch) {
+    auto* msg = PoolNew<Message>(MessageType::TASK_BATCH, batch, mb_);
+    worker->mb->put_init(msg, kMessagePayloadSize * batch->tasks.size())->detach();
+    stats_.task_messages++;
+}
+
+WorkerInfo* Master::PickWorkerSorted(const TaskRequest* req) {
+    std::sort(idle_workers_.begin(), idle_workers_.end(), WorkerOrder());
+    for (auto* worker : idle_workers_) {
+        // XBT_DEBUG("-- w %s: %d %d %d", worker->id.c_str(), worker->cpus_available,
+        // worker->memory_available, worker->speed);
+        if (worker->cpus_available >= req->cores && worker->memory_available >= req->memory) {
+            return worker;
+        }
+    }
+    return nullptr;
+}
+
+WorkerInfo* Master::PickWorkerIndexed(const TaskRequest* req) {
+    for (auto* worker : idle_workers_index_) {
+        // workers are ordered by available memory, so the remaining ones cannot fit the task
+        if (worker->memory_available < req->memory) {
+            break;
+        }
+        if (worker->cpus_available >= req->cores) {
+            return worker;
+        }
+    }
+    return nullptr;
+}
+
+WorkerInfo* Master::PickWorkerWithData(const TaskRequest* req) {
+    if (!prefer_locality_ || req->dataset_id < 0) {
+        return nullptr;
+    }
+    auto it = dataset_locations_.find(req->dataset_id);
+    if (it == dataset_locations_.end()) {
+        return nullptr;
+    }
+    auto* worker = it->second;
+    if (worker->cpus_available >= req->cores && worker->memory_available >= req->memory) {
+        return worker;
+    }
+    return nullptr;
+}
+
+bool Master::HasIdleWorkers() const {
+    return sort_workers_ ? !idle_workers_.empty() : !idle_workers_index_.empty();
+}
+
+void Master::UpdateWorkerResources(WorkerInfo* worker, int cpus_delta, double memory_delta) {
+    bool was_idle = worker->cpus_available > 0 && worker->memory_available > 0;
+    // the key of indexed worker must not be changed in place
+    if (!sort_workers_ && was_idle) {
+        idle_workers_index_.erase(worker);
+    }
+    worker->cpus_available += cpus_delta;
+    worker->memory_available += memory_delta;
+    cpus_available_ += cpus_delta;
+    memory_available_ += memory_delta;
+    bool is_idle = worker->cpus_available > 0 && worker->memory_available > 0;
+    if (!sort_workers_) {
+        if (is_idle) {
+            idle_workers_index_.insert(worker);
+        }
+    } else if (was_idle && !is_idle) {
+        auto it = std::find(idle_workers_.begin(), idle_workers_.end(), worker);
+        std::swap(*it, idle_workers_.back());
+        idle_workers_.pop_back();
+    } else if (!was_idle && is_idle) {
+        idle_workers_.push_back(worker);
+    }
+}
+
+void Master::InsertTaskOrdered(TaskList& list, int slot) {
+    int task_id = tasks_[slot].info.req->id;
+    int prev_slot = list.tail;
+    while (prev_slot != -1 && tasks_[prev_slot].info.req->id > task_id) {
+        prev_slot = tasks_[prev_slot].prev;
+    }
+    auto& entry = tasks_[slot];
+    entry.prev = prev_slot;
+    entry.next = prev_slot == -1 ? list.head : tasks_[prev_slot].next;
+    (entry.prev == -1 ? list.head : tasks_[entry.prev].next) = slot;
+    (entry.next == -1 ? list.tail : tasks_[entry.next].prev) = slot;
+    list.size++;
+}
+
+void Master::AppendTask(TaskList& list, int slot) {
+    auto& entry = tasks_[slot];
+    entry.prev = list.tail;
+    entry.next = -1;
+    (list.tail == -1 ? list.head : tasks_[list.tail].next) = slot;
+    list.tail = slot;
+    list.size++;
+}
+
+void Master::RemoveTask(TaskList& list, int slot) {
+    auto& entry = tasks_[slot];
+    (entry.prev == -1 ? list.head : tasks_[entry.prev].next) = entry.next;
+    (entry.next == -1 ? list.tail : tasks_[entry.next].prev) = entry.prev;
+    entry.prev = entry.next = -1;
+    list.size--;
+}
+
+int Master::AllocateSlot(int task_id) {
+    if (parent_mb_ == nullptr) {
+        return task_id;
+    }
+    int slot;
+    if (free_slots_.empty()) {
+        slot = static_cast<int>(tasks_.size());
+        tasks_.emplace_back();
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    task_slots_.emplace(task_id, slot);
+    return slot;
+}
+
+int Master::GetSlot(int task_id) const {
+    if (parent_mb_ == nullptr) {
+        return task_id;
+    }
+    auto it = task_slots_.find(task_id);
+    xbt_assert(it != task_slots_.end(), "Unknown task %d", task_id);
+    return it->second;
+}
+
+void Master::ReleaseSlot(int task_id) {
+    auto it = task_slots_.find(task_id);
+    free_slots_.push_back(it->second);
+    task_slots_.erase(it);
 }
 
 void Master::ReportStatus() {
-    XBT_INFO("CPU: %f / MEMORY: %f / UNASSIGNED: %ld / ASSIGNED: %ld / COMPLETED: %ld",
+    XBT_INFO("CPU: %f / MEMORY: %f / UNASSIGNED: %u / ASSIGNED: %u / COMPLETED: %u",
              (double)(cpus_total_ - cpus_available_) / cpus_total_,
-             (memory_total_ - memory_available_) / memory_total_, unassigned_tasks_.size(),
-             assigned_tasks_.size(), completed_tasks_.size());
+             (memory_total_ - memory_available_) / memory_total_, unassigned_tasks_.size,
+             assigned_tasks_.size, completed_task_count_);
 }
@@ -2,7 +2,8 @@
 
 #include <unordered_map>
 #include <vector>
-#include <map>
+#include <set>
+#include <tuple>
 
 #include "common.h"
 
@@ -19,9 +20,40 @@ struct WorkerInfo {
     sg4::Mailbox* mb;
 };
 
+// Orders workers by decreasing (memory_available, cpus_available, speed, id)
+struct WorkerOrder {
+    bool operator()(const WorkerInfo* w1, const WorkerInfo* w2) const {
+        return std::tie(w1->memory_available, w1->cpus_available, w1->speed, w1->id) >
+               std::tie(w2->memory_available, w2->cpus_available, w2->speed, w2->id);
+    }
+};
+
+enum class MasterMode { BLOCKING, NONBLOCKING, EVENT_DRIVEN };
+
+struct MasterStats {
+    // total wall time spent in ScheduleTasks, in seconds
+    double scheduling_time = 0;
+    // total wall time spent answering pull requests, in seconds
+    double dispatch_time = 0;
+    // number of pull requests received from workers
+    uint64_t pull_requests = 0;
+    // number of messages with tasks sent to workers
+    uint64_t task_messages = 0;
+};
+
 class Master {
 public:
-    explicit Master(std::string name, uint32_t task_count, bool blocking, double& scheduling_time);
+    // With batch_tasks all tasks assigned to a worker in a scheduling round are sent in a single
+    // TASK_BATCH message.
+    //
+    // With parent_mb the master runs as a sub-master: it manages worker_count workers, registers
+    // on the parent master as a single worker with their total resources once all of them are
+    // registered, schedules the tasks received from the parent on its workers and reports
+    // completions to the parent in batches. It stops on STOP message from the parent.
+    explicit Master(std::string name, uint32_t task_count, MasterMode mode, bool sort_workers,
+                    bool batch_tasks, DispatchMode dispatch_mode, MasterStats& stats,
+                    sg4::Mailbox* parent_mb = nullptr, uint32_t worker_count = 0,
+                    bool prefer_locality = false);
 
     void operator()();
 
@@ -36,26 +68,108 @@ public:
     // receiving
     void NonblockingImpl();
 
+    // Event-driven implementation of main loop
+    // - waits for incoming message with timeout set to the time of the next periodic activity
+    // - periodic activities are not delayed and the actor wakes up only when there is work to do
+    void EventDrivenImpl();
+
 private:
+    void OnMessage(Message* msg);
+    void RunPeriodicActivities();
     void OnWorkerRegister(WorkerRegister* reg, sg4::Mailbox* worker_mb);
     void OnTaskRequest(TaskRequest* req);
+    void OnTaskBatch(TaskBatch* batch);
     void OnTaskCompleted(TaskCompleted* msg, sg4::Mailbox* worker_mb);
+    void OnTaskPull(TaskPull* pull, sg4::Mailbox* worker_mb);
+    void OnTaskCompletedBatch(TaskCompletedBatch* batch, sg4::Mailbox* worker_mb);
+    bool IsRunning() const;
+    // Sub-master only: registers on the parent master and reports completed tasks to it
+    void RegisterOnParent();
+    void ReportCompletions();
+    void CompleteTask(int task_id, WorkerInfo* worker);
     void ScheduleTasks();
+    // Assigns queued tasks to the worker in the order of task ids until the first task that does
+    // not fit into the worker resources
+    void DispatchToWorker(WorkerInfo* worker);
+    // Moves the task in the given slot to assigned ones and sends it to worker, or adds it to the
+    // batch if it is not null (the batch is sent by the caller)
+    void AssignTask(int slot, WorkerInfo* worker, TaskBatch* batch);
+    void SendBatch(WorkerInfo* worker, TaskBatch* batch);
     void ReportStatus();
 
+    // Worker selection for a task: returns the first idle worker in WorkerOrder that can fit the
+    // task, or nullptr if there is no such worker
+    WorkerInfo* PickWorkerSorted(const TaskRequest* req);
+    WorkerInfo* PickWorkerIndexed(const TaskRequest* req);
+    // Returns the idle worker that was last assigned a task with the same input dataset if it can
+    // fit the task, or nullptr
+    WorkerInfo* PickWorkerWithData(const TaskRequest* req);
+    bool HasIdleWorkers() const;
+    // Changes worker resources and keeps idle workers collection up to date
+    void UpdateWorkerResources(WorkerInfo* worker, int cpus_delta, double memory_delta);
+
+    // Intrusive doubly linked list of tasks in the task table, linked by task slots
+    struct TaskList {
+        int head = -1;
+        int tail = -1;
+        uint32_t size = 0;
+    };
+
+    struct TaskEntry {
+        TaskInfo info{nullptr, TaskState::NEW};
+        int prev = -1;
+        int next = -1;
+    };
+
+    // Inserts task keeping the list ordered by id, O(1) when tasks are added in the id order
+    void InsertTaskOrdered(TaskList& list, int slot);
+    void AppendTask(TaskList& list, int slot);
+    void RemoveTask(TaskList& list, int slot);
+
+    // Slot of the task in the task table: the task id itself for the root master, a slot reused
+    // after task completion for sub-master
+    int AllocateSlot(int task_id);
+    int GetSlot(int task_id) const;
+    void ReleaseSlot(int task_id);
+
     uint32_t task_count_ = 0;
-    bool blocking_ = true;
+    MasterMode mode_ = MasterMode::BLOCKING;
+    // Use legacy worker selection which sorts all idle workers for each task
+    bool sort_workers_ = false;
+    bool batch_tasks_ = false;
+    DispatchMode dispatch_mode_ = DispatchMode::PUSH;
     sg4::Mailbox* mb_ = nullptr;
     int cpus_total_ = 0;
     int cpus_available_ = 0;
     double memory_total_ = 0;
     double memory_available_ = 0;
     std::unordered_map<std::string, WorkerInfo*> workers_;
+    // idle workers (with available cpus and memory) in arbitrary order, used with sort_workers_
     std::vector<WorkerInfo*> idle_workers_;
-    std::map<int, TaskInfo> unassigned_tasks_;
-    std::unordered_map<int, TaskInfo> assigned_tasks_;
-    std::unordered_map<int, TaskInfo> completed_tasks_;
+    // idle workers ordered by WorkerOrder, used without sort_workers_
+    std::set<WorkerInfo*, WorkerOrder> idle_workers_index_;
+    // tasks indexed by slot (client generates ids 0..task_count-1 and root master uses them as
+    // slots), task state defines the list the task is linked into: unassigned tasks are ordered by
+    // id, assigned ones by assignment
+    std::vector<TaskEntry> tasks_;
+    // sub-master only: slots of the received tasks which are not completed yet by task id and the
+    // slots of completed tasks, so that the table size is bounded by the number of tasks held by
+    // the sub-master at once rather than by the global task id range
+    std::unordered_map<int, int> task_slots_;
+    std::vector<int> free_slots_;
+    TaskList unassigned_tasks_;
+    TaskList assigned_tasks_;
+    uint32_t completed_task_count_ = 0;
     double next_schedule_time_ = 10;
     double next_report_time_ = 10;
-    double& scheduling_time_;
+    MasterStats& stats_;
+    // sub-master state
+    sg4::Mailbox* parent_mb_ = nullptr;
+    uint32_t worker_count_ = 0;
+    bool has_new_tasks_ = false;
+    bool stopped_ = false;
+    TaskCompletedBatch* completions_ = nullptr;
+    // Prefer workers that likely have the task input dataset in cache
+    bool prefer_locality_ = false;
+    std::unordered_map<int, WorkerInfo*> dataset_locations_;
 };
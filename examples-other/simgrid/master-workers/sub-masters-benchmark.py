@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+
+# Runs master-workers with different numbers of sub-masters for several host and task counts and
+# prints simulated makespan, run time, master time and the maximal sub-master time (wall time spent
+# in scheduling and dispatching) of each run, so that scaling with the number of sub-masters can be
+# seen. K = 0 means that master manages all workers.
+#
+# Example (from build directory):
+#
+#   ../../master-workers/sub-masters-benchmark.py --hosts 1000,10000 --tasks 100000 --sub-masters 0,2,4,8,16 -- --platform star
+
+import argparse
+import itertools
+import json
+import re
+import subprocess
+import sys
+
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+MASTER_TIME_REGEX = re.compile(r"^Master time: ([\d\.]+)s$", re.MULTILINE)
+SUB_MASTER_TIME_REGEX = re.compile(r"^Sub-master time: ([\d\.]+)s total, ([\d\.]+)s max$",
+                                   re.MULTILINE)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--binary", default="bin/master-workers")
+    ap.add_argument("--hosts", default="1000", help="Comma-separated list of host counts")
+    ap.add_argument("--tasks", default="100000", help="Comma-separated list of task counts")
+    ap.add_argument("--sub-masters", default="0,2,4,8",
+                    help="Comma-separated list of sub-master counts")
+    ap.add_argument("extra_args", nargs="*", help="Arguments passed to master-workers (after --)")
+    args = ap.parse_args()
+
+    header = ["hosts", "tasks", "sub-masters", "makespan, s", "run time, s", "master time, s",
+              "sub-master time (max), s"]
+    rows = []
+    for hosts, tasks in itertools.product(args.hosts.split(","), args.tasks.split(",")):
+        for sub_masters in args.sub_masters.split(","):
+            command = [args.binary, hosts, tasks, "--sub-masters", sub_masters,
+                       "--log=root.thres:critical"] + args.extra_args
+            print(f"Running {hosts} hosts, {tasks} tasks with {sub_masters} sub-masters",
+                  file=sys.stderr)
+            proc = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                  text=True)
+            m = RESULT_REGEX.search(proc.stdout)
+            master_time = MASTER_TIME_REGEX.search(proc.stdout)
+            if proc.returncode != 0 or m is None or master_time is None:
+                rows.append([hosts, tasks, sub_masters, "failed", "-", "-", "-"])
+                continue
+            result = json.loads(m.group(1))
+            sub_master_time = SUB_MASTER_TIME_REGEX.search(proc.stdout)
+            rows.append([hosts, tasks, sub_masters, f"{result['sim_time']:.2f}",
+                         f"{result['run_time']:.3f}", master_time.group(1),
+                         sub_master_time.group(2) if sub_master_time else "-"])
+
+    widths = [max(len(x) for x in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(x.ljust(w) for x, w in zip(row, widths)).rstrip())
+
+
+if __name__ == "__main__":
+    main()
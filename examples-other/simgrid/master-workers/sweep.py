@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+# Runs master-workers for all combinations of host counts, task counts and seeds. Each run is a
+# separate engine process, up to --jobs processes (number of CPUs by default) are run in parallel.
+# Results parsed from the RESULT line are collected into a single CSV file.
+#
+# Example (from build directory):
+#
+#   ../../master-workers/sweep.py --hosts 100,1000 --tasks 10000,100000 --seeds 1-8 \
+#       --output sweep.csv -- --master-mode event-driven
+
+import argparse
+import csv
+import itertools
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+
+COLUMNS = ["host_count", "task_count", "seed", "status", "wall_time", "setup_time", "run_time",
+           "sim_time", "tasks_per_sec", "peak_rss_kb"]
+
+
+def int_list(value):
+    """Parses comma-separated list of integers and ranges, e.g. 1,2,10-20."""
+    result = []
+    for item in value.split(","):
+        if "-" in item:
+            first, last = item.split("-")
+            result.extend(range(int(first), int(last) + 1))
+        else:
+            result.append(int(item))
+    return result
+
+
+def run(binary, host_count, task_count, seed, extra_args):
+    command = [binary, str(host_count), str(task_count), "--seed", str(seed),
+               "--log=root.thres:critical"] + extra_args
+    row = {"host_count": host_count, "task_count": task_count, "seed": seed}
+    start = time.monotonic()
+    proc = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+    row["wall_time"] = round(time.monotonic() - start, 3)
+    m = RESULT_REGEX.search(proc.stdout)
+    if proc.returncode != 0 or m is None:
+        row["status"] = f"failed ({proc.returncode})"
+        return row
+    result = json.loads(m.group(1))
+    row["status"] = "ok"
+    for key in ["setup_time", "run_time", "sim_time", "peak_rss_kb"]:
+        row[key] = result[key]
+    row["tasks_per_sec"] = result["events_per_sec"]
+    return row
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--binary", default="bin/master-workers")
+    ap.add_argument("--hosts", type=int_list, required=True)
+    ap.add_argument("--tasks", type=int_list, required=True)
+    ap.add_argument("--seeds", type=int_list, default=[123])
+    ap.add_argument("--jobs", type=int, default=os.cpu_count(),
+                    help="Number of simulations run in parallel")
+    ap.add_argument("--output", default="sweep.csv")
+    ap.add_argument("extra_args", nargs="*", help="Options passed to each run (after --)")
+    args = ap.parse_args()
+
+    configs = list(itertools.product(args.hosts, args.tasks, args.seeds))
+    print(f"Running {len(configs)} simulations using {args.jobs} processes", file=sys.stderr)
+
+    start = time.monotonic()
+    with ThreadPoolExecutor(max_workers=args.jobs) as executor:
+        futures = [executor.submit(run, args.binary, *config, args.extra_args)
+                   for config in configs]
+        rows = []
+        for future in futures:
+            row = future.result()
+            print(f"hosts={row['host_count']} tasks={row['task_count']} seed={row['seed']}: "
+                  f"{row['status']} in {row['wall_time']:.2f}s", file=sys.stderr)
+            rows.append(row)
+    elapsed = time.monotonic() - start
+
+    with open(args.output, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=COLUMNS)
+        writer.writeheader()
+        writer.writerows(rows)
+
+    total_wall_time = sum(row["wall_time"] for row in rows)
+    print(f"Done in {elapsed:.2f}s, sequential time {total_wall_time:.2f}s "
+          f"(speedup {total_wall_time / elapsed:.2f}), results saved to {args.output}",
+          file=sys.stderr)
+    if any(row["status"] != "ok" for row in rows):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
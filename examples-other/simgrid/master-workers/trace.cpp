@@ -0,0 +1,107 @@
+#include "trace.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#include <xbt/asserts.h>
+
+namespace {
+
+constexpr size_t kFileBufferSize = 1 << 20;
+constexpr size_t kMaxLineLength = 512;
+constexpr const char* kCsvHeader = "arrival_time,flops,memory,cores,input_size,output_size";
+
+bool IsBlank(const char* line) {
+    for (; *line != '\0'; line++) {
+        if (!std::isspace(static_cast<unsigned char>(*line))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TraceReader::TraceReader(const std::string& path) : path_(path) {
+    file_ = fopen(path.c_str(), "rb");
+    xbt_assert(file_ != nullptr, "Cannot open trace %s", path.c_str());
+    setvbuf(file_, nullptr, _IOFBF, kFileBufferSize);
+
+    char magic[sizeof(kTraceMagic)];
+    if (fread(magic, 1, sizeof(magic), file_) == sizeof(magic) &&
+        memcmp(magic, kTraceMagic, sizeof(magic)) == 0) {
+        binary_ = true;
+        xbt_assert(fread(&record_count_, sizeof(record_count_), 1, file_) == 1,
+                   "%s: truncated header", path.c_str());
+        long data_start = ftell(file_);
+        fseek(file_, 0, SEEK_END);
+        xbt_assert(static_cast<uint64_t>(ftell(file_) - data_start) ==
+                       record_count_ * sizeof(TraceRecord),
+                   "%s: file size does not match %lu records", path.c_str(), record_count_);
+        fseek(file_, data_start, SEEK_SET);
+        return;
+    }
+
+    rewind(file_);
+    char line[kMaxLineLength];
+    xbt_assert(fgets(line, sizeof(line), file_) != nullptr &&
+                   strncmp(line, kCsvHeader, strlen(kCsvHeader)) == 0,
+               "%s: not a binary trace and no CSV header \"%s\"", path.c_str(), kCsvHeader);
+    has_dataset_column_ = strstr(line, ",dataset_id") != nullptr;
+    line_ = 1;
+    // count records in a separate pass to keep memory independent of the trace length
+    long data_start = ftell(file_);
+    while (fgets(line, sizeof(line), file_) != nullptr) {
+        if (!IsBlank(line)) {
+            record_count_++;
+        }
+    }
+    fseek(file_, data_start, SEEK_SET);
+}
+
+TraceReader::~TraceReader() {
+    if (file_ != nullptr) {
+        fclose(file_);
+    }
+}
+
+size_t TraceReader::Read(TraceRecord* out, size_t n) {
+    if (binary_) {
+        return fread(out, sizeof(TraceRecord), n, file_);
+    }
+    size_t count = 0;
+    while (count < n && ReadCsvRecord(out + count)) {
+        count++;
+    }
+    return count;
+}
+
+bool TraceReader::ReadCsvRecord(TraceRecord* out) {
+    char line[kMaxLineLength];
+    do {
+        if (fgets(line, sizeof(line), file_) == nullptr) {
+            return false;
+        }
+        line_++;
+    } while (IsBlank(line));
+
+    double values[7];
+    size_t field_count = has_dataset_column_ ? 7 : 6;
+    const char* pos = line;
+    for (size_t i = 0; i < field_count; i++) {
+        char* end = nullptr;
+        values[i] = strtod(pos, &end);
+        xbt_assert(end != pos && (i + 1 == field_count || *end == ','),
+                   "%s:%lu: expected %zu numeric fields", path_.c_str(), line_, field_count);
+        pos = end + 1;
+    }
+    out->arrival_time = values[0];
+    out->flops = values[1];
+    out->memory = values[2];
+    out->cores = static_cast<int32_t>(values[3]);
+    out->input_size = values[4];
+    out->output_size = values[5];
+    out->dataset_id = has_dataset_column_ ? static_cast<int32_t>(values[6]) : -1;
+    return true;
+}
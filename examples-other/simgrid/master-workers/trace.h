@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Task trace record. Binary traces store records in this layout (little-endian) after the header,
+// CSV traces have the header line "arrival_time,flops,memory,cores,input_size,output_size" with an
+// optional dataset_id column.
+struct TraceRecord {
+    double arrival_time;
+    double flops;
+    double memory;
+    double input_size;
+    double output_size;
+    int32_t cores;
+    // input dataset shared by tasks, -1 if the input is unique
+    int32_t dataset_id;
+};
+static_assert(sizeof(TraceRecord) == 48, "binary trace layout");
+
+// Binary trace header: magic followed by the number of records
+static inline constexpr char kTraceMagic[8] = {'M', 'W', 'T', 'R', 'A', 'C', 'E', '1'};
+
+// Sequential reader of a task trace, which keeps only a fixed-size file buffer in memory. The format
+// is detected by the magic, so binary traces can have any file name. Records are expected to be
+// sorted by arrival time.
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path);
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    // Number of records in the trace, read from the header of a binary trace or counted in a
+    // separate pass over a CSV trace.
+    uint64_t GetRecordCount() const {
+        return record_count_;
+    }
+
+    // Reads up to n next records and returns the number of records read, 0 at the end of trace.
+    size_t Read(TraceRecord* out, size_t n);
+
+private:
+    bool ReadCsvRecord(TraceRecord* out);
+
+    std::string path_;
+    FILE* file_ = nullptr;
+    bool binary_ = false;
+    bool has_dataset_column_ = false;
+    uint64_t record_count_ = 0;
+    uint64_t line_ = 0;
+};
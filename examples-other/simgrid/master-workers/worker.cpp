@@ -3,28 +3,90 @@
 #include <simgrid/s4u.hpp>
 #include <xbt/random.hpp>
 
+#include <cstdlib>
+#include <string_view>
+
+#include "event_trace.h"
+#include "object_pool.h"
+
+using dslab::simgrid_examples::PoolDelete;
+using dslab::simgrid_examples::PoolNew;
+using dslab::simgrid_examples::RecordEvent;
+
 XBT_LOG_NEW_DEFAULT_CATEGORY(worker, "Worker");
 
+namespace {
+
+// Parses size with unit like "1000GiB" or "10GB" in bytes
+double ParseSize(std::string_view value) {
+    static constexpr std::pair<std::string_view, double> kUnits[] = {
+        {"B", 1.},    {"kB", 1e3},     {"KB", 1e3},     {"MB", 1e6},     {"GB", 1e9},
+        {"TB", 1e12}, {"KiB", 0x1p10}, {"MiB", 0x1p20}, {"GiB", 0x1p30}, {"TiB", 0x1p40}};
+    char* end = nullptr;
+    std::string number(value);
+    double size = std::strtod(number.c_str(), &end);
+    std::string_view unit = value.substr(end - number.c_str());
+    for (const auto& [name, factor] : kUnits) {
+        if (unit == name) {
+            return size * factor;
+        }
+    }
+    xbt_assert(unit.empty(), "Unknown size unit in %s", number.c_str());
+    return size;
+}
+
+}  // namespace
+
+bool InputCache::Lookup(int dataset_id) {
+    auto it = index_.find(dataset_id);
+    if (it == index_.end()) {
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return true;
+}
+
+void InputCache::Insert(int dataset_id, double size) {
+    if (Lookup(dataset_id) || size > capacity_) {
+        return;
+    }
+    while (used_ + size > capacity_) {
+        used_ -= lru_.back().second;
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    lru_.emplace_front(dataset_id, size);
+    index_.emplace(dataset_id, lru_.begin());
+    used_ += size;
+}
+
 Worker::Worker(const std::string& name, int speed, int cores, double memory, bool async_mode,
-               sg4::Mailbox* master_mb, sg4::Host* master_host)
+               sg4::Mailbox* master_mb, sg4::Host* master_host, DispatchMode dispatch_mode,
+               CacheStats* cache_stats)
     : name_(name),
       speed_(speed),
       cores_(cores),
       memory_(memory),
       async_mode_(async_mode),
+      dispatch_mode_(dispatch_mode),
+      cpus_available_(cores),
+      memory_available_(memory),
       master_mb_(master_mb),
-      master_host_(master_host) {
+      master_host_(master_host),
+      cache_stats_(cache_stats) {
     mb_ = sg4::Mailbox::by_name(name);
 }
 
 void Worker::operator()() {
     mb_->set_receiver(sg4::Actor::self());
+    if (const char* disk_size = sg4::Host::current()->get_disks().front()->get_property("size")) {
+        cache_ = InputCache(ParseSize(disk_size));
+    }
     RegisterOnMaster();
 
     // start message receive activity
     Message* msg;
-    auto comm = mb_->get_async<Message>(&msg);
-    pending_activities_.push_back(comm);
+    AddPendingActivity(mb_->get_async<Message>(&msg), -1, ActivityKind::MESSAGE);
 
     bool stopped = false;
     while (!stopped) {
@@ -32,124 +94,166 @@ void Worker::operator()() {
         // disk I/O...)
         ssize_t changed_pos = sg4::Activity::wait_any(pending_activities_);
         if (changed_pos != -1) {
-            auto* completed = pending_activities_[changed_pos].get();
-            XBT_DEBUG("Completed %s", completed->get_cname());
-            const std::string& completed_name = completed->get_name();
-            // message received
-            if (completed_name == "unnamed") {
-                switch (msg->type) {
-                    case MessageType::TASK_REQUEST: {
-                        if (async_mode_) {
-                            // process task asynchronously
-                            OnTaskRequestAsync(static_cast<TaskRequest*>(msg->data));
-                        } else {
-                            // process task synchronously
-                            OnTaskRequestAsync(static_cast<TaskRequest*>(msg->data));
+            auto [task_id, kind] = pending_activities_info_[changed_pos];
+            XBT_DEBUG("Completed activity %d of task %d", static_cast<int>(kind), task_id);
+            RecordEvent(MasterWorkersEvent::ACTIVITY_COMPLETED, task_id, static_cast<int>(kind));
+            switch (kind) {
+                // message received
+                case ActivityKind::MESSAGE: {
+                    switch (msg->type) {
+                        case MessageType::TASK_REQUEST: {
+                            if (async_mode_) {
+                                // process task asynchronously
+                                OnTaskRequestAsync(static_cast<TaskRequest*>(msg->data));
+                            } else {
+                                // process task synchronously
+                                OnTaskRequestAsync(static_cast<TaskRequest*>(msg->data));
+                            }
+                            break;
+                        }
+                        case MessageType::TASK_BATCH: {
+                            auto* batch = static_cast<TaskBatch*>(msg->data);
+                            for (auto* req : batch->tasks) {
+                                OnTaskRequestAsync(req);
+                            }
+                            PoolDelete(batch);
+                            break;
                         }
-                        break;
+                        case MessageType::STOP: {
+                            XBT_DEBUG("Got STOP");
+                            stopped = true;
+                            break;
+                        }
+                        default:
+                            std::abort();
                     }
-                    case MessageType::STOP: {
-                        XBT_DEBUG("Got STOP");
-                        stopped = true;
-                        break;
+                    PoolDelete(msg);
+                    // start next message receive activity
+                    if (!stopped) {
+                        AddPendingActivity(mb_->get_async<Message>(&msg), -1,
+                                           ActivityKind::MESSAGE);
                     }
-                    default:
-                        std::abort();
-                }
-                delete msg;
-                // start next message receive activity
-                if (!stopped) {
-                    comm = mb_->get_async<Message>(&msg);
-                    pending_activities_.push_back(comm);
+                    break;
                 }
                 // task-related activities
-            } else {
-                int task_id = activity_tasks_[completed_name];
-                activity_tasks_.erase(completed_name);
-                // data download completed
-                if (completed_name.starts_with("download-")) {
+                case ActivityKind::DOWNLOAD:
                     OnDataDownloadCompleted(task_id);
-                    // data upload completed
-                } else if (completed_name.starts_with("upload-")) {
-                    OnDataUploadCompleted(task_id);
-                    // task execution completed
-                } else if (completed_name.starts_with("exec-")) {
-                    OnTaskExecCompleted(task_id);
-                    // disk read completed
-                } else if (completed_name.starts_with("read-")) {
+                    break;
+                case ActivityKind::READ:
                     OnDataReadCompleted(task_id);
-                    // disk write completed
-                } else if (completed_name.starts_with("write-")) {
+                    break;
+                case ActivityKind::EXEC:
+                    OnTaskExecCompleted(task_id);
+                    break;
+                case ActivityKind::WRITE:
                     OnDataWriteCompleted(task_id);
-                }
+                    break;
+                case ActivityKind::UPLOAD:
+                    OnDataUploadCompleted(task_id);
+                    break;
             }
             std::swap(pending_activities_[changed_pos], pending_activities_.back());
+            std::swap(pending_activities_info_[changed_pos], pending_activities_info_.back());
             pending_activities_.pop_back();
+            pending_activities_info_.pop_back();
         }
     }
     XBT_DEBUG("Exiting");
 }
 
+void Worker::AddPendingActivity(sg4::ActivityPtr activity, int task_id, ActivityKind kind) {
+    pending_activities_.push_back(std::move(activity));
+    pending_activities_info_.push_back(ActivityInfo{task_id, kind});
+}
+
 void Worker::RegisterOnMaster() {
-    auto* reg = new WorkerRegister{name_, speed_, cores_, memory_};
-    auto* msg = new Message(MessageType::WORKER_REGISTER, reg, mb_);
+    auto* reg = PoolNew<WorkerRegister>(name_, speed_, cores_, memory_);
+    auto* msg = PoolNew<Message>(MessageType::WORKER_REGISTER, reg, mb_);
     master_mb_->put(msg, kMessagePayloadSize);
 }
 
 // Synchronous version of task processing (slow, since it processes only a single task at time)
 void Worker::OnTaskRequestSync(TaskRequest* req) {
     XBT_DEBUG("Task %d: received", req->id);
+    RecordEvent(MasterWorkersEvent::TASK_RECEIVED, req->id);
     tasks_.emplace(req->id, TaskInfo{req, TaskState::DOWNLOADING});
 
     // download task input data from master
     sg4::Comm::sendto(master_host_, sg4::this_actor::get_host(), req->input_size);
     XBT_DEBUG("Task %d: downloaded input", req->id);
+    RecordEvent(MasterWorkersEvent::ACTIVITY_COMPLETED, req->id,
+                static_cast<int>(ActivityKind::DOWNLOAD));
 
     // read input data from disk
     tasks_[req->id].state = TaskState::READING;
     sg4::Host::current()->get_disks().front()->read(req->input_size);
     XBT_DEBUG("Task %d: read input", req->id);
+    RecordEvent(MasterWorkersEvent::ACTIVITY_COMPLETED, req->id,
+                static_cast<int>(ActivityKind::READ));
 
     // run task
     tasks_[req->id].state = TaskState::RUNNING;
     sg4::this_actor::execute(req->flops);
     XBT_DEBUG("Task %d: completed execution", req->id);
+    RecordEvent(MasterWorkersEvent::ACTIVITY_COMPLETED, req->id,
+                static_cast<int>(ActivityKind::EXEC));
 
     // write output data to disk
     tasks_[req->id].state = TaskState::WRITING;
     sg4::Host::current()->get_disks().front()->write(req->output_size);
     XBT_DEBUG("Task %d: wrote output", req->id);
+    RecordEvent(MasterWorkersEvent::ACTIVITY_COMPLETED, req->id,
+                static_cast<int>(ActivityKind::WRITE));
 
     // upload task output data to master
     tasks_[req->id].state = TaskState::UPLOADING;
     sg4::Comm::sendto(sg4::this_actor::get_host(), master_host_, req->output_size);
     XBT_DEBUG("Task %d: uploaded output", req->id);
+    RecordEvent(MasterWorkersEvent::ACTIVITY_COMPLETED, req->id,
+                static_cast<int>(ActivityKind::UPLOAD));
 
     tasks_[req->id].state = TaskState::COMPLETED;
-    auto* msg = new Message(MessageType::TASK_COMPLETED, new TaskCompleted{req->id}, mb_);
+    auto* msg = PoolNew<Message>(MessageType::TASK_COMPLETED, PoolNew<TaskCompleted>(req->id), mb_);
     master_mb_->put(msg, kMessagePayloadSize);
 }
 
 void Worker::OnTaskRequestAsync(TaskRequest* req) {
     int task_id = req->id;
     XBT_DEBUG("Task %d: received", task_id);
+    RecordEvent(MasterWorkersEvent::TASK_RECEIVED, task_id);
     tasks_.emplace(req->id, TaskInfo{req, TaskState::DOWNLOADING});
+    cpus_available_ -= req->cores;
+    memory_available_ -= req->memory;
+    if (req->dataset_id >= 0) {
+        // the dataset being downloaded for another task is not in cache yet, so it is downloaded
+        // again
+        bool hit = cache_.Lookup(req->dataset_id);
+        if (cache_stats_ != nullptr) {
+            ++(hit ? cache_stats_->hits : cache_stats_->misses);
+            cache_stats_->bytes_saved += hit ? req->input_size : 0;
+        }
+        if (hit) {
+            XBT_DEBUG("Task %d: input dataset %d is cached", task_id, req->dataset_id);
+            RecordEvent(MasterWorkersEvent::CACHE_HIT, task_id, req->dataset_id);
+            OnDataDownloadCompleted(task_id);
+            return;
+        }
+    }
     // download task input data asynchronously
     auto comm =
-        sg4::Comm::sendto_async(master_host_, sg4::this_actor::get_host(), req->output_size);
-    comm->set_name("download-" + std::to_string(task_id));
-    pending_activities_.push_back(comm);
-    activity_tasks_.emplace(comm->get_name(), task_id);
+        sg4::Comm::sendto_async(master_host_, sg4::this_actor::get_host(), req->input_size);
+    AddPendingActivity(comm, task_id, ActivityKind::DOWNLOAD);
 }
 
 void Worker::OnDataDownloadCompleted(int task_id) {
     auto& task = tasks_[task_id];
+    if (task.req->dataset_id >= 0) {
+        cache_.Insert(task.req->dataset_id, task.req->input_size);
+    }
     task.state = TaskState::READING;
     // read data from disk asynchronously
     auto io = sg4::Host::current()->get_disks().front()->read_async(task.req->input_size);
-    io->set_name("read-" + std::to_string(task_id));
-    pending_activities_.push_back(io);
-    activity_tasks_.emplace(io->get_name(), task_id);
+    AddPendingActivity(io, task_id, ActivityKind::READ);
 }
 
 void Worker::OnDataReadCompleted(int task_id) {
@@ -157,9 +261,7 @@ void Worker::OnDataReadCompleted(int task_id) {
     task.state = TaskState::RUNNING;
     // execute task asynchronously
     auto exec = sg4::this_actor::exec_async(task.req->flops);
-    exec->set_name("exec-" + std::to_string(task_id));
-    pending_activities_.push_back(exec);
-    activity_tasks_.emplace(exec->get_name(), task_id);
+    AddPendingActivity(exec, task_id, ActivityKind::EXEC);
 }
 
 void Worker::OnTaskExecCompleted(int task_id) {
@@ -167,9 +269,7 @@ void Worker::OnTaskExecCompleted(int task_id) {
     task.state = TaskState::WRITING;
     // write data to disk asynchronously
     auto io = sg4::Host::current()->get_disks().front()->write_async(task.req->output_size);
-    io->set_name("write-" + std::to_string(task_id));
-    pending_activities_.push_back(io);
-    activity_tasks_.emplace(io->get_name(), task_id);
+    AddPendingActivity(io, task_id, ActivityKind::WRITE);
 }
 
 void Worker::OnDataWriteCompleted(int task_id) {
@@ -178,15 +278,22 @@ void Worker::OnDataWriteCompleted(int task_id) {
     // upload task output data asynchronously
     auto comm =
         sg4::Comm::sendto_async(sg4::this_actor::get_host(), master_host_, task.req->output_size);
-    comm->set_name("upload-" + std::to_string(task_id));
-    pending_activities_.push_back(comm);
-    activity_tasks_.emplace(comm->get_name(), task_id);
+    AddPendingActivity(comm, task_id, ActivityKind::UPLOAD);
 }
 
 void Worker::OnDataUploadCompleted(int task_id) {
     auto& task = tasks_[task_id];
     task.state = TaskState::COMPLETED;
+    cpus_available_ += task.req->cores;
+    memory_available_ += task.req->memory;
+    if (dispatch_mode_ == DispatchMode::PULL) {
+        // report task completion and request new tasks for the freed resources
+        auto* pull = PoolNew<TaskPull>(task_id);
+        auto* msg = PoolNew<Message>(MessageType::TASK_PULL, pull, mb_);
+        master_mb_->put(msg, kMessagePayloadSize);
+        return;
+    }
     // report task completion to master
-    auto* msg = new Message(MessageType::TASK_COMPLETED, new TaskCompleted{task_id}, mb_);
+    auto* msg = PoolNew<Message>(MessageType::TASK_COMPLETED, PoolNew<TaskCompleted>(task_id), mb_);
     master_mb_->put(msg, kMessagePayloadSize);
 }
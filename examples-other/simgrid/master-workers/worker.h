@@ -1,14 +1,55 @@
 #pragma once
 
+#include <list>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common.h"
 
+// Kind of activity pending in worker
+enum class ActivityKind { MESSAGE, DOWNLOAD, READ, EXEC, WRITE, UPLOAD };
+
+struct ActivityInfo {
+    int task_id;
+    ActivityKind kind;
+};
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // input data not downloaded from master due to cache hits
+    double bytes_saved = 0;
+};
+
+// LRU cache of task input datasets stored on worker disk
+class InputCache {
+public:
+    explicit InputCache(double capacity = 0) : capacity_(capacity) {
+    }
+
+    // Returns whether the dataset is cached and marks it as recently used
+    bool Lookup(int dataset_id);
+    // Adds the dataset evicting the least recently used ones, datasets larger than capacity are
+    // not cached
+    void Insert(int dataset_id, double size);
+
+private:
+    double capacity_ = 0;
+    double used_ = 0;
+    // (dataset id, size), most recently used first
+    std::list<std::pair<int, double>> lru_;
+    std::unordered_map<int, std::list<std::pair<int, double>>::iterator> index_;
+};
+
 class Worker {
 public:
+    // Inputs of tasks with dataset_id are cached on worker disk, cache capacity is given by "size"
+    // property of the disk. Cache statistics are accumulated in cache_stats if it is not null.
     explicit Worker(const std::string& name, int speed, int cores, double memory, bool async_mode,
-                    sg4::Mailbox* master_mb, sg4::Host* master_host);
+                    sg4::Mailbox* master_mb, sg4::Host* master_host,
+                    DispatchMode dispatch_mode = DispatchMode::PUSH,
+                    CacheStats* cache_stats = nullptr);
 
     void operator()();
 
@@ -23,16 +64,24 @@ private:
     void OnTaskExecCompleted(int task_id);
     void OnDataWriteCompleted(int task_id);
     void OnDataUploadCompleted(int task_id);
+    void AddPendingActivity(sg4::ActivityPtr activity, int task_id, ActivityKind kind);
 
     std::string name_;
     int speed_;
     int cores_;
     double memory_;
     bool async_mode_ = true;
+    DispatchMode dispatch_mode_ = DispatchMode::PUSH;
+    // resources not used by received tasks, reported to master in pull requests
+    int cpus_available_ = 0;
+    double memory_available_ = 0;
     std::unordered_map<int, TaskInfo> tasks_;
     sg4::Mailbox* mb_ = nullptr;
     sg4::Mailbox* master_mb_ = nullptr;
     sg4::Host* master_host_ = nullptr;
     std::vector<sg4::ActivityPtr> pending_activities_;
-    std::unordered_map<std::string, int> activity_tasks_;
+    // pending_activities_[i] is described by pending_activities_info_[i]
+    std::vector<ActivityInfo> pending_activities_info_;
+    InputCache cache_;
+    CacheStats* cache_stats_ = nullptr;
 };
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+
+# Compares actor-per-process mode with driver mode (processes run as state machines in a few actors)
+# for several process counts and ping windows, and prints run time, throughput (wall-clock and
+# simulated) and peak RSS of each run.
+#
+# Examples (from build directory):
+#
+#   ../../ping-pong/drivers-benchmark.py --procs 10000,100000,1000000 --drivers 0,1,8
+#   ../../ping-pong/drivers-benchmark.py --procs 1000,10000 --drivers 0 --windows 1,10,100
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--binary", default="bin/ping-pong")
+    ap.add_argument("--platform",
+                    default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "platform.xml"))
+    ap.add_argument("--procs", default="10000,100000,1000000",
+                    help="Comma-separated list of process counts")
+    ap.add_argument("--drivers", default="0,1,8",
+                    help="Comma-separated list of driver counts, 0 means actor per process")
+    ap.add_argument("--windows", default="1",
+                    help="Comma-separated list of numbers of pings in flight per process")
+    ap.add_argument("--peers", type=int, default=1)
+    ap.add_argument("--iterations", type=int, default=10)
+    args = ap.parse_args()
+
+    header = ["procs", "drivers", "window", "setup time, s", "run time, s", "messages/s",
+              "sim messages/s", "peak RSS, KB"]
+    rows = []
+    for procs in args.procs.split(","):
+        for drivers in args.drivers.split(","):
+            for window in args.windows.split(","):
+                command = [args.binary, procs, str(args.peers), "0", "0", str(args.iterations),
+                           args.platform, "--drivers", drivers, "--window", window,
+                           "--log=root.thres:critical"]
+                print(f"Running {procs} processes with {drivers} drivers, window {window}",
+                      file=sys.stderr)
+                proc = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                      text=True)
+                m = RESULT_REGEX.search(proc.stdout)
+                if proc.returncode != 0 or m is None:
+                    rows.append([procs, drivers, window, "failed", "-", "-", "-", "-"])
+                    continue
+                result = json.loads(m.group(1))
+                sim_rate = result["events"] / result["sim_time"] if result["sim_time"] > 0 else 0
+                rows.append([procs, drivers, window, f"{result['setup_time']:.3f}",
+                             f"{result['run_time']:.3f}", f"{result['events_per_sec']:.0f}",
+                             f"{sim_rate:.0f}", str(result["peak_rss_kb"])])
+
+    widths = [max(len(x) for x in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(x.ljust(w) for x, w in zip(row, widths)).rstrip())
+
+
+if __name__ == "__main__":
+    main()
@@ -1,12 +1,27 @@
+#include <chrono>
+#include <iostream>
+#include <optional>
+
+#include <argparse/argparse.hpp>
 #include <boost/format.hpp>
 #include <simgrid/s4u.hpp>
 #include <xbt/random.hpp>
 
+#include "context_options.h"
+#include "event_trace.h"
+#include "instrumentation.h"
 #include "process.h"
+#include "run_stats.h"
+#include "topology.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(main, "Main");
 
 int main(int argc, char* argv[]) {
+    dslab::simgrid_examples::RunStats run_stats("ping-pong");
+    // --context-factory, --nthreads and --stack-size are passed to the engine as --cfg options
+    dslab::simgrid_examples::ContextArguments context_args(argc, argv);
+    argc = *context_args.Argc();
+    argv = context_args.Argv();
     sg4::Engine e(&argc, argv);
     // use simple network config
     sg4::Engine::set_config("network/latency-factor:1");
@@ -16,67 +31,236 @@ int main(int argc, char* argv[]) {
     sg4::Engine::set_config("network/crosstraffic:0");
     simgrid::xbt::random::XbtRandom random(123);
 
-    xbt_assert(
-        argc == 7,
-        "Usage: %s PROC_COUNT PEER_COUNT ASYMMETRIC DISTRIBUTED ITERATIONS platform_file.xml",
-        argv[0]);
-    unsigned int proc_count = std::stoi(argv[1]);
-    unsigned int peer_count = std::stoi(argv[2]);
-    bool asymmetric = std::stoi(argv[3]);
-    bool distributed = std::stoi(argv[4]);
-    unsigned int iterations = std::stoi(argv[5]);
+    argparse::ArgumentParser parser("ping-pong");
+    auto str_to_uint = [](const std::string& value) {
+        return static_cast<unsigned int>(std::stoul(value));
+    };
+    auto str_to_bool = [](const std::string& value) { return std::stoi(value) != 0; };
+    parser.add_argument("proc_count").help("Number of processes (>= 2)").action(str_to_uint);
+    parser.add_argument("peer_count").help("Number of process peers (>= 1)").action(str_to_uint);
+    parser.add_argument("asymmetric").help("Asymmetric mode (0 or 1)").action(str_to_bool);
+    parser.add_argument("distributed")
+        .help("Place processes on two hosts (0 or 1)")
+        .action(str_to_bool);
+    parser.add_argument("iterations").help("Number of iterations (>= 1)").action(str_to_uint);
+    parser.add_argument("platform")
+        .help("Platform file, or fat-tree:N or dragonfly:N to generate a platform with N hosts");
+    parser.add_argument("--link-sharing")
+        .help("Sharing policy of links in generated platform: shared (default) or fatpipe")
+        .nargs(1)
+        .default_value(std::string("shared"));
+    parser.add_argument("--drivers")
+        .help("Run processes as state machines in the given number of driver actors instead of "
+              "an actor per process (0, default)")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(0u);
+    parser.add_argument("--window")
+        .help("Number of pings each process keeps in flight (1, default, waits for the reply to "
+              "each ping)")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(1u);
+    parser.add_argument("--rtt-histogram")
+        .help("Record simulated round-trip times and print their quantiles")
+        .default_value(false)
+        .implicit_value(true);
+    parser.add_argument("--event-trace")
+        .help("Record binary event trace to the given file, see decode-event-trace.py")
+        .nargs(1)
+        .default_value(std::string());
+    parser.add_argument("--event-trace-ring")
+        .help("Keep only the given number of last events in the event trace (0, default, keeps "
+              "all events)")
+        .nargs(1)
+        .action(str_to_uint)
+        .default_value(0u);
+    parser.add_argument("--instrument")
+        .help("Collect activity, solver round and context switch counters and print a summary")
+        .default_value(false)
+        .implicit_value(true);
+
+    unsigned int proc_count = 0, peer_count = 0, iterations = 0, driver_count = 0, window = 1,
+                 event_trace_ring = 0;
+    std::string event_trace_path, platform;
+    std::optional<TopologySpec> topology;
+    auto link_sharing = sg4::Link::SharingPolicy::SHARED;
+    bool asymmetric = false, distributed = false, record_rtt = false, instrument = false;
+    try {
+        parser.parse_args(argc, argv);
+        proc_count = parser.get<unsigned int>("proc_count");
+        peer_count = parser.get<unsigned int>("peer_count");
+        asymmetric = parser.get<bool>("asymmetric");
+        distributed = parser.get<bool>("distributed");
+        iterations = parser.get<unsigned int>("iterations");
+        driver_count = parser.get<unsigned int>("--drivers");
+        window = parser.get<unsigned int>("--window");
+        record_rtt = parser.get<bool>("--rtt-histogram");
+        instrument = parser.get<bool>("--instrument");
+        event_trace_path = parser.get<std::string>("--event-trace");
+        event_trace_ring = parser.get<unsigned int>("--event-trace-ring");
+        platform = parser.get<std::string>("platform");
+        topology = ParseTopology(platform);
+        auto sharing = parser.get<std::string>("--link-sharing");
+        if (sharing == "shared") {
+            link_sharing = sg4::Link::SharingPolicy::SHARED;
+        } else if (sharing == "fatpipe") {
+            link_sharing = sg4::Link::SharingPolicy::FATPIPE;
+        } else {
+            throw std::runtime_error("unknown link sharing policy: " + sharing);
+        }
+    } catch (const std::runtime_error& re) {
+        std::cerr << "Argument parse error: " << re.what() << "\n";
+        std::cerr << parser << "\n";
+        std::exit(1);
+    }
     xbt_assert(peer_count > 0, "PEER_COUNT should be positive");
     xbt_assert(iterations > 0, "ITERATIONS should be positive");
+    xbt_assert(window > 0, "--window should be positive");
     xbt_assert(!asymmetric || proc_count % 2 == 0,
                "ASYMMETRIC case is supported only for even PROC_COUNT");
     xbt_assert(!asymmetric || peer_count == 1,
                "ASYMMETRIC case is supported only for PEER_COUNT=1");
-    e.load_platform(argv[6]);
-
-    std::vector<std::string> process_names;
-    std::vector<sg4::Mailbox*> process_mailboxes;
-    for (unsigned int i = 1; i <= proc_count; i++) {
-        auto proc_name = (boost::format("proc%1%") % i).str();
-        process_names.push_back(proc_name);
-        process_mailboxes.push_back(sg4::Mailbox::by_name(proc_name));
+    xbt_assert(driver_count <= proc_count, "--drivers should not exceed PROC_COUNT");
+    // process i runs on host (2 - i % 2) and driver d runs processes d + 1, d + 1 + N, ..., so
+    // all processes of a driver are on the same host only for even N
+    xbt_assert(!distributed || topology || driver_count % 2 == 0,
+               "DISTRIBUTED case requires even number of drivers");
+    std::optional<dslab::simgrid_examples::Instrumentation> instrumentation;
+    if (instrument) {
+        instrumentation.emplace();
     }
-    sg4::Actor::create("root", sg4::Host::by_name("host1"), Root, sg4::Mailbox::by_name("root"),
-                       process_mailboxes, asymmetric);
-    for (unsigned int i = 1; i <= proc_count; i++) {
-        auto host_name = distributed ? (boost::format("host%1%") % (2 - i % 2)).str() : "host1";
-        std::vector<sg4::Mailbox*> peers;
+    std::optional<dslab::simgrid_examples::EventTracer> event_tracer;
+    if (!event_trace_path.empty()) {
+        event_tracer.emplace(event_trace_path, PingPongEventNames(), event_trace_ring);
+    }
+    auto platform_start = std::chrono::steady_clock::now();
+    unsigned int host_count = 0;
+    if (topology) {
+        host_count = BuildTopology(*topology, link_sharing);
+    } else {
+        e.load_platform(platform);
+        host_count = e.get_host_count();
+    }
+    printf("Platform construction time: %.2fs (%u hosts), peak RSS %ld KB\n",
+           dslab::simgrid_examples::ToSeconds(std::chrono::steady_clock::now() - platform_start),
+           host_count, dslab::simgrid_examples::GetPeakRss());
+
+    // In distributed case with platform file process i runs on host (2 - i % 2) and driver d runs
+    // on host (1 + d % 2). With generated platform processes are spread over all hosts: process i
+    // runs on host (1 + (i - 1) % N) and driver d on host (1 + d % N), processes of a driver are
+    // considered to run on its host.
+    auto process_host = [&](unsigned int i) {
+        if (!distributed) {
+            return sg4::Host::by_name("host1");
+        }
+        unsigned int host_id = topology ? 1 + (i - 1) % host_count : 2 - i % 2;
+        return sg4::Host::by_name((boost::format("host%1%") % host_id).str());
+    };
+    auto driver_host = [&](unsigned int d) {
+        if (!distributed) {
+            return sg4::Host::by_name("host1");
+        }
+        unsigned int host_id = topology ? 1 + d % host_count : 1 + d % 2;
+        return sg4::Host::by_name((boost::format("host%1%") % host_id).str());
+    };
+
+    // peers are generated in the same order in both modes, so that the modes send the same messages
+    auto generate_peers = [&](unsigned int i) {
+        std::vector<int> peers;
         if (peer_count == 1) {
-            auto peer_id = i % proc_count + 1;
-            peers.push_back(process_mailboxes[peer_id - 1]);
+            peers.push_back(i % proc_count + 1);
         } else {
             while (peers.size() < peer_count) {
                 unsigned int peer_id = random.uniform_int(1, proc_count);
                 if (peer_id != i) {
-                    peers.push_back(process_mailboxes[peer_id - 1]);
+                    peers.push_back(peer_id);
                 }
             }
         }
-        if (asymmetric) {
+        return peers;
+    };
+
+    if (driver_count > 0) {
+        std::vector<sg4::Mailbox*> driver_mailboxes;
+        for (unsigned int d = 0; d < driver_count; d++) {
+            driver_mailboxes.push_back(
+                sg4::Mailbox::by_name((boost::format("driver%1%") % d).str()));
+        }
+        std::vector<std::vector<ProcessSpec>> driver_processes(driver_count);
+        for (unsigned int i = 1; i <= proc_count; i++) {
             bool is_pinger = i % 2;
-            sg4::Mailbox* out = peers[0];
-            sg4::Actor::create(process_names[i - 1], sg4::Host::by_name(host_name),
-                               ProcessAsymmetric, is_pinger, process_mailboxes[i - 1], out,
-                               iterations);
-        } else {
-            sg4::Actor::create(process_names[i - 1], sg4::Host::by_name(host_name), Process, i,
-                               process_mailboxes[i - 1], peers, iterations);
+            driver_processes[(i - 1) % driver_count].push_back(
+                ProcessSpec{static_cast<int>(i), generate_peers(i), is_pinger});
+        }
+        sg4::Actor::create("root", sg4::Host::by_name("host1"), Root,
+                           sg4::Mailbox::by_name("root"), driver_mailboxes, asymmetric,
+                           record_rtt);
+        for (unsigned int d = 0; d < driver_count; d++) {
+            sg4::Actor::create((boost::format("driver%1%") % d).str(), driver_host(d), Driver,
+                               driver_mailboxes[d], driver_mailboxes,
+                               std::move(driver_processes[d]), asymmetric, iterations, window,
+                               record_rtt);
+        }
+    } else {
+        std::vector<std::string> process_names;
+        std::vector<sg4::Mailbox*> process_mailboxes;
+        for (unsigned int i = 1; i <= proc_count; i++) {
+            auto proc_name = (boost::format("proc%1%") % i).str();
+            process_names.push_back(proc_name);
+            process_mailboxes.push_back(sg4::Mailbox::by_name(proc_name));
+        }
+        sg4::Actor::create("root", sg4::Host::by_name("host1"), Root,
+                           sg4::Mailbox::by_name("root"), process_mailboxes, asymmetric,
+                           record_rtt);
+        for (unsigned int i = 1; i <= proc_count; i++) {
+            auto* host = process_host(i);
+            std::vector<sg4::Mailbox*> peers;
+            for (int peer_id : generate_peers(i)) {
+                peers.push_back(process_mailboxes[peer_id - 1]);
+            }
+            if (asymmetric) {
+                bool is_pinger = i % 2;
+                sg4::Mailbox* out = peers[0];
+                sg4::Actor::create(process_names[i - 1], host, ProcessAsymmetric, is_pinger,
+                                   process_mailboxes[i - 1], out, iterations, window, record_rtt);
+            } else {
+                sg4::Actor::create(process_names[i - 1], host, Process, i, process_mailboxes[i - 1],
+                                   peers, iterations, window, record_rtt);
+            }
         }
     }
 
-    auto start = std::chrono::steady_clock::now();
+    run_stats.SetupDone();
+    if (instrumentation) {
+        instrumentation->RunStarted();
+    }
     e.run();
-    auto stop = std::chrono::steady_clock::now();
-    auto duration =
-        static_cast<double>(
-            std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count()) /
-        1000;
+    if (instrumentation) {
+        instrumentation->RunDone();
+    }
+    // each iteration is a PING and a PONG message, in asymmetric mode only half of the processes
+    // send pings
+    uint64_t message_count = static_cast<uint64_t>(proc_count) * iterations * (asymmetric ? 1 : 2);
+    run_stats.RunDone(e.get_clock(), message_count);
+    auto duration = run_stats.GetRunTime();
     if (duration > 0) {
         printf("Processed %d iterations in %.2fs (%.2f iter/s)\n", iterations, duration,
                iterations / duration);
     }
+    printf("Messages: %lu (%.2f msg/s simulated, %.2f msg/s wall-clock)\n",
+           static_cast<unsigned long>(message_count),
+           e.get_clock() > 0 ? message_count / e.get_clock() : 0.,
+           duration > 0 ? message_count / duration : 0.);
+    if (instrumentation) {
+        instrumentation->Print();
+    }
+    if (event_tracer) {
+        event_tracer->Close();
+        printf("Event trace: %lu events written to %s (%lu dropped)\n",
+               static_cast<unsigned long>(event_tracer->GetWrittenCount()),
+               event_trace_path.c_str(),
+               static_cast<unsigned long>(event_tracer->GetDroppedCount()));
+    }
+    run_stats.Print();
 }
@@ -1,118 +1,332 @@
 #include "process.h"
 
+#include <cstdio>
+#include <memory>
+
 #include <boost/format.hpp>
 #include <simgrid/s4u.hpp>
 #include <xbt/random.hpp>
 
+#include "event_trace.h"
+#include "object_pool.h"
+
+using dslab::simgrid_examples::PoolDelete;
+using dslab::simgrid_examples::PoolNew;
+using dslab::simgrid_examples::RecordEvent;
+
 XBT_LOG_NEW_DEFAULT_CATEGORY(ping_pong, "Ping-Pong");
 
 void Message::Destroy(void* message) {
-    delete static_cast<Message*>(message);
+    PoolDelete(static_cast<Message*>(message));
 }
 
-void Root(sg4::Mailbox* in, std::vector<sg4::Mailbox*> process_mailboxes, bool asymmetric) {
+void Root(sg4::Mailbox* in, std::vector<sg4::Mailbox*> process_mailboxes, bool asymmetric,
+          bool record_rtt) {
     in->set_receiver(sg4::Actor::self());
     int active_proc_count = process_mailboxes.size();
     for (auto const& mailbox : process_mailboxes) {
-        auto* start = new Message(MessageType::START, sg4::Engine::get_clock(), in);
+        auto* start = PoolNew<Message>(MessageType::START, sg4::Engine::get_clock(), in);
         mailbox->put_init(start, 1)->detach(Message::Destroy);
     }
-    if (!asymmetric) {
+    Histogram rtt_histogram;
+    if (!asymmetric || record_rtt) {
         while (active_proc_count > 0) {
             auto* msg = in->get<Message>();
             xbt_assert(msg->type == MessageType::COMPLETED);
             XBT_INFO("Received COMPLETED");
-            delete msg;
+            if (msg->rtt_histogram != nullptr) {
+                rtt_histogram.Merge(*msg->rtt_histogram);
+                delete msg->rtt_histogram;
+            }
+            PoolDelete(msg);
             --active_proc_count;
         }
+    }
+    if (!asymmetric) {
         for (auto const& mailbox : process_mailboxes) {
-            auto* stop = new Message(MessageType::STOP, sg4::Engine::get_clock(), in);
+            auto* stop = PoolNew<Message>(MessageType::STOP, sg4::Engine::get_clock(), in);
             mailbox->put_init(stop, 1)->detach(Message::Destroy);
             XBT_INFO("Sent STOP");
         }
     }
+    if (record_rtt) {
+        printf("RTT: %lu samples, p50 %.6f, p99 %.6f, max %.6f\n",
+               static_cast<unsigned long>(rtt_histogram.GetCount()),
+               rtt_histogram.GetQuantile(0.5), rtt_histogram.GetQuantile(0.99),
+               rtt_histogram.GetMax());
+    }
 }
 
-void Process(int id, sg4::Mailbox* in, std::vector<sg4::Mailbox*> peers, int iterations) {
+void Process(int id, sg4::Mailbox* in, std::vector<sg4::Mailbox*> peers, int iterations,
+             int window, bool record_rtt) {
     in->set_receiver(sg4::Actor::self());
     simgrid::xbt::random::XbtRandom random;
     random.set_seed(id);
+    auto rtt_histogram = record_rtt ? std::make_unique<Histogram>() : nullptr;
 
     // wait for Start message
     auto* msg = in->get<Message>();
     xbt_assert(msg->type == MessageType::START);
     sg4::Mailbox* root = msg->from;
-    delete msg;
+    PoolDelete(msg);
     XBT_INFO("Started");
+    RecordEvent(PingPongEvent::STARTED, id);
 
     unsigned int peer_count = peers.size();
     int pings_to_send = iterations;
-    bool wait_reply = false;
+    int in_flight = 0;
     bool stopped = false;
     while (!stopped) {
-        if (pings_to_send > 0 && !wait_reply) {
+        // keep up to window pings in flight
+        while (pings_to_send > 0 && in_flight < window) {
             // select ping target (avoiding calling random for single peer seems to give slight
             // speed improvement)
             sg4::Mailbox* out =
                 (peer_count == 1) ? peers[0] : peers[random.uniform_int(0, peer_count - 1)];
-            auto* ping = new Message(MessageType::PING, sg4::Engine::get_clock(), in);
+            auto* ping = PoolNew<Message>(MessageType::PING, sg4::Engine::get_clock(), in);
             out->put_init(ping, kMessagePayloadSize)
                 ->detach(Message::Destroy);  // out->put_async is very slow
             XBT_INFO("Sent PING");
+            RecordEvent(PingPongEvent::SENT_PING, id);
             pings_to_send -= 1;
-            wait_reply = true;
+            in_flight += 1;
         }
 
         msg = in->get<Message>();
         if (msg->type == MessageType::PING) {
             XBT_INFO("Received PING");
-            auto* pong = new Message(MessageType::PONG, sg4::Engine::get_clock(), in);
+            RecordEvent(PingPongEvent::RECEIVED_PING, id);
+            auto* pong = PoolNew<Message>(MessageType::PONG, msg->payload, in);
             msg->from->put_init(pong, kMessagePayloadSize)
                 ->detach(Message::Destroy);  // out->put_async is very slow
             XBT_INFO("Sent PONG");
+            RecordEvent(PingPongEvent::SENT_PONG, id);
         } else if (msg->type == MessageType::PONG) {
             XBT_INFO("Received PONG");
-            wait_reply = false;
-            if (pings_to_send == 0) {
+            RecordEvent(PingPongEvent::RECEIVED_PONG, id);
+            if (rtt_histogram) {
+                rtt_histogram->Record(sg4::Engine::get_clock() - msg->payload);
+            }
+            in_flight -= 1;
+            if (pings_to_send == 0 && in_flight == 0) {
                 XBT_INFO("Completed");
-                auto* completed = new Message(MessageType::COMPLETED, sg4::Engine::get_clock(), in);
+                RecordEvent(PingPongEvent::COMPLETED, id);
+                auto* completed =
+                    PoolNew<Message>(MessageType::COMPLETED, sg4::Engine::get_clock(), in);
+                completed->rtt_histogram = rtt_histogram.release();
                 root->put(completed, 1);
             }
         } else if (msg->type == MessageType::STOP) {
             XBT_INFO("Received STOP");
             stopped = true;
         }
-        delete msg;
+        PoolDelete(msg);
     }
     xbt_assert(pings_to_send == 0);
     XBT_INFO("Stopped");
+    RecordEvent(PingPongEvent::STOPPED, id);
 }
 
-void ProcessAsymmetric(bool is_pinger, sg4::Mailbox* in, sg4::Mailbox* out, int iterations) {
+void ProcessAsymmetric(bool is_pinger, sg4::Mailbox* in, sg4::Mailbox* out, int iterations,
+                       int window, bool record_rtt) {
     in->set_receiver(sg4::Actor::self());
+    auto rtt_histogram = record_rtt && is_pinger ? std::make_unique<Histogram>() : nullptr;
     // wait for Start message
     auto* msg = in->get<Message>();
     xbt_assert(msg->type == MessageType::START);
-    delete msg;
+    sg4::Mailbox* root = msg->from;
+    PoolDelete(msg);
     XBT_INFO("Started");
 
-    while (iterations > 0) {
-        if (is_pinger) {
-            auto* ping = new Message(MessageType::PING, sg4::Engine::get_clock(), in);
-            out->put(ping, kMessagePayloadSize);
-            XBT_INFO("Sent PING");
+    // with a single ping in flight messages are sent with blocking put, so that the default mode
+    // measures the same rendezvous as before, the window mode needs detached sends
+    auto send = [window](sg4::Mailbox* to, Message* msg) {
+        if (window == 1) {
+            to->put(msg, kMessagePayloadSize);
+        } else {
+            to->put_init(msg, kMessagePayloadSize)->detach(Message::Destroy);
+        }
+    };
+    if (is_pinger) {
+        int pings_to_send = iterations;
+        int in_flight = 0;
+        while (pings_to_send > 0 || in_flight > 0) {
+            while (pings_to_send > 0 && in_flight < window) {
+                send(out, PoolNew<Message>(MessageType::PING, sg4::Engine::get_clock(), in));
+                XBT_INFO("Sent PING");
+                RecordEvent(PingPongEvent::SENT_PING);
+                pings_to_send -= 1;
+                in_flight += 1;
+            }
             auto* pong = in->get<Message>();
             XBT_INFO("Received PONG");
-            delete pong;
-            iterations -= 1;
-        } else {
+            RecordEvent(PingPongEvent::RECEIVED_PONG);
+            if (rtt_histogram) {
+                rtt_histogram->Record(sg4::Engine::get_clock() - pong->payload);
+            }
+            PoolDelete(pong);
+            in_flight -= 1;
+        }
+    } else {
+        for (; iterations > 0; --iterations) {
             auto* ping = in->get<Message>();
             XBT_INFO("Received PING");
-            auto* pong = new Message(MessageType::PONG, sg4::Engine::get_clock(), in);
-            ping->from->put(pong, kMessagePayloadSize);
+            RecordEvent(PingPongEvent::RECEIVED_PING);
+            send(ping->from, PoolNew<Message>(MessageType::PONG, ping->payload, in));
             XBT_INFO("Sent PONG");
-            delete ping;
-            --iterations;
+            RecordEvent(PingPongEvent::SENT_PONG);
+            PoolDelete(ping);
         }
     }
+    if (record_rtt) {
+        auto* completed = PoolNew<Message>(MessageType::COMPLETED, sg4::Engine::get_clock(), in);
+        completed->rtt_histogram = rtt_histogram.release();
+        root->put(completed, 1);
+    }
+}
+
+namespace {
+
+class DriverImpl {
+public:
+    DriverImpl(sg4::Mailbox* in, std::vector<sg4::Mailbox*> driver_mailboxes,
+               std::vector<ProcessSpec> processes, bool asymmetric, int iterations, int window,
+               bool record_rtt)
+        : in_(in),
+          driver_mailboxes_(std::move(driver_mailboxes)),
+          asymmetric_(asymmetric),
+          window_(window),
+          rtt_histogram_(record_rtt ? std::make_unique<Histogram>() : nullptr) {
+        states_.reserve(processes.size());
+        for (auto& spec : processes) {
+            State state{std::move(spec), iterations, 0, nullptr};
+            if (state.spec.peers.size() > 1) {
+                // same generator as in Process, created only when random peers are needed
+                state.random = std::make_unique<simgrid::xbt::random::XbtRandom>();
+                state.random->set_seed(state.spec.id);
+            }
+            states_.push_back(std::move(state));
+        }
+    }
+
+    void Run() {
+        in_->set_receiver(sg4::Actor::self());
+        // wait for Start message
+        auto* msg = in_->get<Message>();
+        xbt_assert(msg->type == MessageType::START);
+        root_ = msg->from;
+        PoolDelete(msg);
+        XBT_INFO("Started %zu processes", states_.size());
+
+        for (auto& state : states_) {
+            SendPings(state);
+        }
+        bool stopped = false;
+        while (!stopped && !(asymmetric_ && completed_count_ == states_.size())) {
+            msg = in_->get<Message>();
+            if (msg->type == MessageType::STOP) {
+                XBT_INFO("Received STOP");
+                stopped = true;
+            } else {
+                OnMessage(states_[(msg->to_id - 1) / driver_mailboxes_.size()], msg);
+            }
+            PoolDelete(msg);
+        }
+        xbt_assert(completed_count_ == states_.size());
+        XBT_INFO("Stopped");
+    }
+
+private:
+    struct State {
+        ProcessSpec spec;
+        int iterations_left;  // pings to send, or pings to answer for asymmetric ponger
+        int in_flight;        // pings waiting for reply
+        std::unique_ptr<simgrid::xbt::random::XbtRandom> random;
+    };
+
+    void Send(MessageType type, double payload, int from_id, int to_id) {
+        auto* msg = PoolNew<Message>(type, payload, in_);
+        msg->from_id = from_id;
+        msg->to_id = to_id;
+        driver_mailboxes_[(to_id - 1) % driver_mailboxes_.size()]
+            ->put_init(msg, kMessagePayloadSize)
+            ->detach(Message::Destroy);
+    }
+
+    void SendPing(State& state) {
+        const auto& peers = state.spec.peers;
+        int peer_id =
+            (peers.size() == 1) ? peers[0] : peers[state.random->uniform_int(0, peers.size() - 1)];
+        Send(MessageType::PING, sg4::Engine::get_clock(), state.spec.id, peer_id);
+        XBT_INFO("Process %d sent PING", state.spec.id);
+        RecordEvent(PingPongEvent::SENT_PING, state.spec.id, peer_id);
+        state.iterations_left -= 1;
+        state.in_flight += 1;
+    }
+
+    // Sends pings until window pings are in flight, asymmetric ponger only answers pings
+    void SendPings(State& state) {
+        if (asymmetric_ && !state.spec.is_pinger) {
+            return;
+        }
+        while (state.iterations_left > 0 && state.in_flight < window_) {
+            SendPing(state);
+        }
+    }
+
+    void OnCompleted(State& state) {
+        XBT_INFO("Process %d completed", state.spec.id);
+        RecordEvent(PingPongEvent::COMPLETED, state.spec.id);
+        ++completed_count_;
+        if ((!asymmetric_ || rtt_histogram_) && completed_count_ == states_.size()) {
+            auto* completed =
+                PoolNew<Message>(MessageType::COMPLETED, sg4::Engine::get_clock(), in_);
+            completed->rtt_histogram = rtt_histogram_.release();
+            root_->put_init(completed, 1)->detach(Message::Destroy);
+        }
+    }
+
+    void OnMessage(State& state, Message* msg) {
+        if (msg->type == MessageType::PING) {
+            XBT_INFO("Process %d received PING", state.spec.id);
+            RecordEvent(PingPongEvent::RECEIVED_PING, state.spec.id, msg->from_id);
+            Send(MessageType::PONG, msg->payload, state.spec.id, msg->from_id);
+            XBT_INFO("Process %d sent PONG", state.spec.id);
+            RecordEvent(PingPongEvent::SENT_PONG, state.spec.id, msg->from_id);
+            if (asymmetric_ && --state.iterations_left == 0) {
+                OnCompleted(state);
+            }
+        } else if (msg->type == MessageType::PONG) {
+            XBT_INFO("Process %d received PONG", state.spec.id);
+            RecordEvent(PingPongEvent::RECEIVED_PONG, state.spec.id, msg->from_id);
+            if (rtt_histogram_) {
+                rtt_histogram_->Record(sg4::Engine::get_clock() - msg->payload);
+            }
+            state.in_flight -= 1;
+            if (state.iterations_left == 0 && state.in_flight == 0) {
+                OnCompleted(state);
+            }
+        }
+        // the process sends the next ping once a reply to one of the previous pings is received
+        SendPings(state);
+    }
+
+    sg4::Mailbox* in_;
+    sg4::Mailbox* root_ = nullptr;
+    std::vector<sg4::Mailbox*> driver_mailboxes_;
+    std::vector<State> states_;
+    bool asymmetric_;
+    int window_;
+    std::unique_ptr<Histogram> rtt_histogram_;
+    size_t completed_count_ = 0;
+};
+
+}  // namespace
+
+void Driver(sg4::Mailbox* in, std::vector<sg4::Mailbox*> driver_mailboxes,
+            std::vector<ProcessSpec> processes, bool asymmetric, int iterations, int window,
+            bool record_rtt) {
+    DriverImpl(in, std::move(driver_mailboxes), std::move(processes), asymmetric, iterations,
+               window, record_rtt)
+        .Run();
 }
@@ -2,18 +2,49 @@
 
 #include <simgrid/forward.h>
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
+#include "histogram.h"
+
+using dslab::simgrid_examples::Histogram;
+
 static inline constexpr int kMessagePayloadSize = 10;
 
 enum class MessageType { START, PING, PONG, COMPLETED, STOP };
 
 namespace sg4 = simgrid::s4u;
 
+// Events recorded with --event-trace: id0 is the process id (0 in asymmetric mode without drivers,
+// where processes have no ids), id1 is the peer process id if known
+enum class PingPongEvent : uint16_t {
+    STARTED,
+    SENT_PING,
+    RECEIVED_PING,
+    SENT_PONG,
+    RECEIVED_PONG,
+    COMPLETED,
+    STOPPED
+};
+
+// Event names in PingPongEvent order
+inline std::vector<std::string> PingPongEventNames() {
+    return {"started",       "sent_ping", "received_ping", "sent_pong",
+            "received_pong", "completed", "stopped"};
+}
+
 struct Message {
     MessageType type;
-    double payload;  // current sender time is used as a message payload
+    // current sender time is used as a message payload, PONG carries the payload of its PING, so
+    // that the pinger can compute the round-trip time
+    double payload;
     sg4::Mailbox* from = nullptr;
+    // ids of sender and receiver processes, used by drivers which run many processes in one actor
+    int from_id = 0;
+    int to_id = 0;
+    // round-trip times measured by the sender, passed to root with COMPLETED (root takes ownership)
+    Histogram* rtt_histogram = nullptr;
 
     explicit Message(MessageType type, double payload, sg4::Mailbox* from)
         : type(type), payload(payload), from(from) {
@@ -22,6 +53,29 @@ struct Message {
     static void Destroy(void* message);
 };
 
-void Root(sg4::Mailbox* in, std::vector<sg4::Mailbox*> process_mailboxes, bool asymmetric);
-void Process(int id, sg4::Mailbox* in, std::vector<sg4::Mailbox*> peers, int iterations);
-void ProcessAsymmetric(bool is_pinger, sg4::Mailbox* in, sg4::Mailbox* out, int iterations);
+// Process run by a driver: process id, ids of its peers and role in asymmetric case
+struct ProcessSpec {
+    int id;
+    std::vector<int> peers;
+    bool is_pinger;
+};
+
+// Processes keep up to window pings in flight, sending the next ping when a PONG is received, so
+// window 1 means waiting for the reply to each ping.
+//
+// With record_rtt processes measure round-trip times of their pings and report them with COMPLETED
+// (also sent in asymmetric case), root merges them and prints the quantiles.
+void Root(sg4::Mailbox* in, std::vector<sg4::Mailbox*> process_mailboxes, bool asymmetric,
+          bool record_rtt);
+void Process(int id, sg4::Mailbox* in, std::vector<sg4::Mailbox*> peers, int iterations,
+             int window, bool record_rtt);
+void ProcessAsymmetric(bool is_pinger, sg4::Mailbox* in, sg4::Mailbox* out, int iterations,
+                       int window, bool record_rtt);
+
+// Runs many processes in a single actor, each process is a state machine driven by messages
+// instead of a blocking loop in its own actor. Messages for process with given id are sent to
+// driver_mailboxes[(id - 1) % driver_mailboxes.size()], the driver reports COMPLETED to root when
+// all its processes are completed. Round-trip times are collected in a single histogram per driver.
+void Driver(sg4::Mailbox* in, std::vector<sg4::Mailbox*> driver_mailboxes,
+            std::vector<ProcessSpec> processes, bool asymmetric, int iterations, int window,
+            bool record_rtt);
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+
+# Runs distributed ping-pong on generated platforms of several sizes with SHARED and FATPIPE links
+# and prints platform construction time and memory separately from the simulation itself. Each host
+# runs --procs-per-host processes.
+#
+# Example (from build directory):
+#
+#   ../../ping-pong/topology-benchmark.py --topologies fat-tree,dragonfly --hosts 1000,10000,100000
+
+import argparse
+import json
+import re
+import subprocess
+import sys
+
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+PLATFORM_REGEX = re.compile(
+    r"^Platform construction time: ([\d\.]+)s \((\d+) hosts\), peak RSS (\d+) KB$", re.MULTILINE)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--binary", default="bin/ping-pong")
+    ap.add_argument("--topologies", default="fat-tree,dragonfly",
+                    help="Comma-separated list of topologies: fat-tree, dragonfly")
+    ap.add_argument("--hosts", default="1000,10000,100000",
+                    help="Comma-separated list of host counts")
+    ap.add_argument("--link-sharing", default="shared,fatpipe",
+                    help="Comma-separated list of link sharing policies: shared, fatpipe")
+    ap.add_argument("--procs-per-host", type=int, default=1)
+    ap.add_argument("--peers", type=int, default=1)
+    ap.add_argument("--iterations", type=int, default=10)
+    ap.add_argument("extra_args", nargs="*", help="Additional ping-pong arguments (after --)")
+    args = ap.parse_args()
+
+    header = ["topology", "hosts", "links", "platform time, s", "platform RSS, KB",
+              "run time, s", "messages/s", "peak RSS, KB"]
+    rows = []
+    for topology in args.topologies.split(","):
+        for hosts in args.hosts.split(","):
+            for sharing in args.link_sharing.split(","):
+                procs = int(hosts) * args.procs_per_host
+                command = [args.binary, str(procs), str(args.peers), "0", "1",
+                           str(args.iterations), f"{topology}:{hosts}", "--link-sharing", sharing,
+                           "--log=root.thres:critical"] + args.extra_args
+                print(f"Running {topology} with {hosts} hosts, {sharing} links", file=sys.stderr)
+                proc = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                      text=True)
+                m = RESULT_REGEX.search(proc.stdout)
+                platform = PLATFORM_REGEX.search(proc.stdout)
+                if proc.returncode != 0 or m is None or platform is None:
+                    rows.append([topology, hosts, sharing, "failed", "-", "-", "-", "-"])
+                    continue
+                result = json.loads(m.group(1))
+                rows.append([topology, platform.group(2), sharing, platform.group(1),
+                             platform.group(3), f"{result['run_time']:.3f}",
+                             f"{result['events_per_sec']:.0f}", str(result["peak_rss_kb"])])
+
+    widths = [max(len(x) for x in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(x.ljust(w) for x, w in zip(row, widths)).rstrip())
+
+
+if __name__ == "__main__":
+    main()
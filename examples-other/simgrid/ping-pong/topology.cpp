@@ -0,0 +1,91 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// same as netlink in platform.xml, but with a typical datacenter link latency since routes have
+// several hops
+constexpr double kLinkBandwidth = 12.5e9;  // 100Gbps
+constexpr double kLinkLatency = 10e-6;
+constexpr double kHostSpeed = 1e9;
+
+// fat-tree: two levels, kFatTreeLeafSize hosts per leaf switch, each leaf switch is connected to
+// all (up to kFatTreeMaxSpines) spine switches
+constexpr unsigned int kFatTreeLeafSize = 16;
+constexpr unsigned int kFatTreeMaxSpines = 4;
+
+// dragonfly: groups of kDragonflyChassis chassis with kDragonflyRouters routers, each router
+// connects kDragonflyNodes hosts
+constexpr unsigned int kDragonflyChassis = 2;
+constexpr unsigned int kDragonflyRouters = 4;
+constexpr unsigned int kDragonflyNodes = 4;
+constexpr unsigned int kDragonflyGroupSize =
+    kDragonflyChassis * kDragonflyRouters * kDragonflyNodes;
+
+unsigned int DivideRoundUp(unsigned int value, unsigned int divisor) {
+    return (value + divisor - 1) / divisor;
+}
+
+}  // namespace
+
+std::optional<TopologySpec> ParseTopology(const std::string& platform) {
+    const std::pair<const char*, TopologySpec::Kind> kinds[] = {
+        {"fat-tree:", TopologySpec::Kind::FAT_TREE}, {"dragonfly:", TopologySpec::Kind::DRAGONFLY}};
+    for (const auto& [prefix, kind] : kinds) {
+        std::string prefix_str(prefix);
+        if (platform.compare(0, prefix_str.size(), prefix_str) != 0) {
+            continue;
+        }
+        auto count = platform.substr(prefix_str.size());
+        if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos ||
+            std::stoul(count) < 2) {
+            throw std::runtime_error("invalid host count in topology: " + platform);
+        }
+        return TopologySpec{kind, static_cast<unsigned int>(std::stoul(count))};
+    }
+    return std::nullopt;
+}
+
+unsigned int BuildTopology(const TopologySpec& spec, sg4::Link::SharingPolicy sharing_policy) {
+    auto create_host = [](sg4::NetZone* zone, const std::vector<unsigned long>& /*coord*/,
+                          unsigned long id) {
+        const sg4::Host* host =
+            zone->create_host("host" + std::to_string(id + 1), kHostSpeed)->seal();
+        return std::make_pair(host->get_netpoint(), nullptr);
+    };
+    // loopback link is used for intra-host communications, as in platform.xml
+    auto create_loopback = [](sg4::NetZone* zone, const std::vector<unsigned long>& /*coord*/,
+                              unsigned long id) -> sg4::Link* {
+        return zone->create_link("host" + std::to_string(id + 1) + "-loopback", "100GBps")
+            ->set_sharing_policy(sg4::Link::SharingPolicy::FATPIPE)
+            ->set_latency(0)
+            ->seal();
+    };
+    sg4::ClusterCallbacks callbacks(create_host, create_loopback, {});
+
+    sg4::NetZone* zone = nullptr;
+    unsigned int host_count = 0;
+    if (spec.kind == TopologySpec::Kind::FAT_TREE) {
+        unsigned int leaf_size = std::min(spec.host_count, kFatTreeLeafSize);
+        unsigned int leaves = DivideRoundUp(spec.host_count, leaf_size);
+        unsigned int spines = std::min(leaves, kFatTreeMaxSpines);
+        zone = sg4::create_fatTree_zone(
+            "fat-tree", nullptr, sg4::FatTreeParams(2, {leaf_size, leaves}, {1, spines}, {1, 1}),
+            callbacks, kLinkBandwidth, kLinkLatency, sharing_policy);
+        host_count = leaf_size * leaves;
+    } else {
+        unsigned int groups = DivideRoundUp(spec.host_count, kDragonflyGroupSize);
+        zone = sg4::create_dragonfly_zone(
+            "dragonfly", nullptr,
+            sg4::DragonflyParams({groups, 1}, {kDragonflyChassis, 1}, {kDragonflyRouters, 1},
+                                 kDragonflyNodes),
+            callbacks, kLinkBandwidth, kLinkLatency, sharing_policy);
+        host_count = groups * kDragonflyGroupSize;
+    }
+    zone->seal();
+    return host_count;
+}
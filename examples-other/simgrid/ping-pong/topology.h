@@ -0,0 +1,24 @@
+#pragma once
+
+#include <simgrid/s4u.hpp>
+
+#include <optional>
+#include <string>
+
+namespace sg4 = simgrid::s4u;
+
+// Platform generated in code instead of loading a platform file, hosts are named host1..hostN
+struct TopologySpec {
+    enum class Kind { FAT_TREE, DRAGONFLY };
+    Kind kind;
+    unsigned int host_count;
+};
+
+// Parses topology given instead of a platform file as "fat-tree:N" or "dragonfly:N", returns
+// std::nullopt for other values (platform file names), throws std::runtime_error for invalid N.
+std::optional<TopologySpec> ParseTopology(const std::string& platform);
+
+// Builds the platform with at least spec.host_count hosts, the count is rounded up to fill the last
+// switch (fat-tree) or group (dragonfly). All network links use the given sharing policy, host
+// loopback links are FATPIPE. Returns the number of created hosts.
+unsigned int BuildTopology(const TopologySpec& spec, sg4::Link::SharingPolicy sharing_policy);
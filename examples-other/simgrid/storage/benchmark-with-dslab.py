@@ -40,13 +40,19 @@ def main():
     ap.add_argument("--disks-list", required=True)
     ap.add_argument("--max-size", type=int, required=True)
     ap.add_argument("--max-start-time", type=int, required=True)
+    ap.add_argument("--simgrid-completion-modes", default="wait-any",
+                    help="Comma-separated list of SimGrid completion modes (wait-any, callback)")
+    ap.add_argument("--simgrid-start-mode", default="mailbox")
+    ap.add_argument("--simgrid-disk-profiles", default="linear",
+                    help="Comma-separated list of SimGrid disk profiles (linear, degradation, "
+                         "size-bandwidth, mixed), DSLab always uses linear read-only disks")
     args = ap.parse_args()
 
     def run(binary, additional_args, requests, disks, use_stderr=False):
         command = [os.getenv("DSLAB_BASE_DIR", "") + "/" + binary, "--requests", str(requests),
                    "--disks", str(disks), "--max-size", str(args.max_size), "--max-start-time", str(args.max_start_time)]
         if additional_args:
-            command.append(additional_args)
+            command.extend(additional_args)
 
         joined_command = " ".join(command)
         # print(f"Running: \"{joined_command}\"")
@@ -59,9 +65,17 @@ def main():
         print(f"Reqs: {requests}, Disks: {disks}, ", end="")
         dslab_time = get_dslab_data(
             run(DSLAB_BINARY_PATH, DSLAB_ADDITIONAL_ARGS, requests, disks))
-        simgrid_time = get_simgrid_data(
-            run(SIMGRID_BINARY_PATH, SIMGRID_ADDITIONAL_ARGS, requests, disks))
-        print(f"Dslab: {dslab_time}, SimGrid: {simgrid_time}")
+        print(f"Dslab: {dslab_time}", end="")
+        for profile in args.simgrid_disk_profiles.split(","):
+            for mode in args.simgrid_completion_modes.split(","):
+                simgrid_args = ["--start-mode", args.simgrid_start_mode, "--completion-mode", mode,
+                                "--disk-profile", profile]
+                if SIMGRID_ADDITIONAL_ARGS:
+                    simgrid_args.append(SIMGRID_ADDITIONAL_ARGS)
+                simgrid_time = get_simgrid_data(
+                    run(SIMGRID_BINARY_PATH, simgrid_args, requests, disks))
+                print(f", SimGrid ({profile}, {mode}): {simgrid_time}", end="")
+        print()
 
     requests_list = args.requests_list.split(",")
     disks_list = args.disks_list.split(",")
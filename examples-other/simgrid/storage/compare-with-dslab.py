@@ -58,9 +58,9 @@ def get_data(lines, on_start_regex, on_complete_regex):
 
 def get_simgrid_data(lines):
     on_start_regex = re.compile(
-        "\[sample\_host:runner:\(2\) ([\d\.]+)\] \[disk\_test\/INFO\] Starting request #(\d+): read from disk\-([\d]+), size = ([\d]+), expected start time = ([\d\.]+)")
+        "\[[^\]]* ([\d\.]+)\] \[disk\_test\/INFO\] Starting request #(\d+): read from disk\-([\d]+), size = ([\d]+), expected start time = ([\d\.]+)")
     on_complete_regex = re.compile(
-        "\[sample\_host:runner:\(2\) ([\d\.]+)\] \[disk\_test\/INFO\] Completed request #(\d+): read from disk\-([\d]+), size = ([\d]+), elapsed simulation time = ([\d\.]+)")
+        "\[[^\]]* ([\d\.]+)\] \[disk\_test\/INFO\] Completed request #(\d+): read from disk\-([\d]+), size = ([\d]+), elapsed simulation time = ([\d\.]+)")
     requests = get_data(lines, on_start_regex, on_complete_regex)
     print("SimGrid requests count:", len(requests))
     return requests
@@ -2,6 +2,10 @@
 
 #include <simgrid/s4u.hpp>
 
+#include <charconv>
+#include <iterator>
+#include <limits>
+
 namespace dslab::simgrid_examples {
 
 DisksSuite::DisksSuite(sg4::Host* host, std::string name_prefix, double read_bw, double write_bw)
@@ -25,11 +29,33 @@ void DisksSuite::SetWriteBandwidthFunction(BandwidthFunction bf) {
 }
 
 void DisksSuite::MakeDisks(uint64_t count) {
-    disks_.reserve(count);
+    disks_.reserve(disks_.size() + count);
+
+    // A single callback object is built and copied to all disks. It only captures `this`, so the
+    // copies fit std::function small buffer and do not allocate.
+    std::function<double(sg_size_t, sg4::Io::OpType)> factor_cb;
+    if (read_bf_ || write_bf_) {
+        factor_cb = [this](sg_size_t size, sg4::Io::OpType op) {
+            if (op == sg4::Io::OpType::READ && read_bf_) {
+                return read_bf_(size);
+            } else if (op == sg4::Io::OpType::WRITE && write_bf_) {
+                return write_bf_(size);
+            }
+            return 1.;
+        };
+    }
 
-    for (size_t idx = 1; idx <= count; ++idx) {
-        auto disk =
-            host_->create_disk(name_prefix_ + "-" + std::to_string(idx), read_bw_, write_bw_);
+    // Disk names are formatted in a single reused buffer instead of concatenating temporaries
+    std::string name = name_prefix_ + "-";
+    const size_t name_prefix_size = name.size();
+    char idx_buffer[std::numeric_limits<uint64_t>::digits10 + 1];
+
+    const size_t first_idx = disks_.size() + 1;
+    for (size_t idx = first_idx; idx < first_idx + count; ++idx) {
+        auto [idx_end, ec] = std::to_chars(std::begin(idx_buffer), std::end(idx_buffer), idx);
+        name.resize(name_prefix_size);
+        name.append(idx_buffer, idx_end);
+        auto disk = host_->create_disk(name, read_bw_, write_bw_);
 
         if (read_degradation_rule_) {
             disk->set_sharing_policy(sg4::Disk::Operation::READ,
@@ -45,15 +71,8 @@ void DisksSuite::MakeDisks(uint64_t count) {
             disk->set_sharing_policy(sg4::Disk::Operation::WRITE, sg4::Disk::SharingPolicy::LINEAR);
         }
 
-        if (read_bf_ || write_bf_) {
-            disk->set_factor_cb([this](sg_size_t size, sg4::Io::OpType op) {
-                if (op == sg4::Io::OpType::READ && read_bf_) {
-                    return read_bf_(size);
-                } else if (op == sg4::Io::OpType::WRITE && write_bf_) {
-                    return write_bf_(size);
-                }
-                return 1.;
-            });
+        if (factor_cb) {
+            disk->set_factor_cb(factor_cb);
         }
 
         disk->seal();
@@ -65,4 +84,8 @@ sg4::IoPtr DisksSuite::ReadAsync(uint64_t disk_idx, uint64_t size) {
     return disks_[disk_idx]->read_async(size);
 }
 
+sg4::IoPtr DisksSuite::WriteAsync(uint64_t disk_idx, uint64_t size) {
+    return disks_[disk_idx]->write_async(size);
+}
+
 }  // namespace dslab::simgrid_examples
@@ -26,6 +26,7 @@ public:
     void MakeDisks(uint64_t count);
 
     sg4::IoPtr ReadAsync(uint64_t disk_idx, uint64_t size);
+    sg4::IoPtr WriteAsync(uint64_t disk_idx, uint64_t size);
 
 private:
     sg4::Host* host_;
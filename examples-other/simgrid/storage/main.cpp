@@ -1,5 +1,7 @@
 #include "disk.h"
+#include "instrumentation.h"
 #include "random.h"
+#include "run_stats.h"
 
 #include <argparse/argparse.hpp>
 
@@ -10,10 +12,17 @@
 
 #include <simgrid/s4u.hpp>
 
+#include <algorithm>
+#include <bit>
 #include <random>
 #include <iostream>
+#include <functional>
+#include <optional>
+#include <utility>
 
 using dslab::simgrid_examples::DisksSuite;
+using dslab::simgrid_examples::Instrumentation;
+using dslab::simgrid_examples::RunStats;
 namespace sg4 = simgrid::s4u;
 
 static constexpr uint64_t kReadBw = 100;
@@ -34,8 +43,8 @@ std::unique_ptr<DisksSuite> MakeSimpleDisks(sg4::Host* host, uint64_t count) {
     return suit;
 }
 
-[[maybe_unused]] std::unique_ptr<DisksSuite> MakeDisksWithDegradation(sg4::Host* host,
-                                                                      uint64_t count) {
+// Read capacity is halved when more than 1000 requests share a disk (NONLINEAR sharing policy)
+std::unique_ptr<DisksSuite> MakeDisksWithDegradation(sg4::Host* host, uint64_t count) {
     auto suit = std::make_unique<DisksSuite>(host, "dedrading-disk", kReadBw, kWriteBw);
     suit->SetReadCapacityDegradation([]([[maybe_unused]] double capacity, int n_requests) {
         if (n_requests > 1000) {
@@ -47,30 +56,69 @@ std::unique_ptr<DisksSuite> MakeSimpleDisks(sg4::Host* host, uint64_t count) {
     return suit;
 }
 
-template <typename F>
-void RunWithTimeMeasure(F&& f) {
+// Each request additionally takes kSeekTime, as if kSeekTime * bandwidth more bytes were
+// transferred, so small requests get lower effective bandwidth (I/O factor callback)
+std::unique_ptr<DisksSuite> MakeDisksWithSizeBandwidth(sg4::Host* host, uint64_t count) {
+    static constexpr double kSeekTime = 1.;
+    auto suit = std::make_unique<DisksSuite>(host, "size-bw-disk", kReadBw, kWriteBw);
+    auto make_bf = [](double bw) {
+        return [seek_size = kSeekTime * bw](sg_size_t size) {
+            if (size == 0) {
+                return 1.;
+            }
+            return size / (size + seek_size);
+        };
+    };
+    suit->SetReadBandwidthFunction(make_bf(kReadBw));
+    suit->SetWriteBandwidthFunction(make_bf(kWriteBw));
+    suit->MakeDisks(count);
+    return suit;
+}
+
+std::unique_ptr<DisksSuite> MakeDisksWithProfile(const std::string& profile, sg4::Host* host,
+                                                 uint64_t count) {
+    if (profile == "degradation") {
+        return MakeDisksWithDegradation(host, count);
+    } else if (profile == "size-bandwidth") {
+        return MakeDisksWithSizeBandwidth(host, count);
+    }
+    // mixed profile uses simple disks, it differs only in requests
+    return MakeSimpleDisks(host, count);
+}
+
+size_t ElapsedMs(std::chrono::steady_clock::time_point start_time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                 start_time)
+        .count();
+}
+
+// Setup (platform, requests and actors creation) and simulation are measured separately, so that
+// scaling with the number of disks and requests reflects the simulation cost
+template <typename S, typename F>
+void RunWithTimeMeasure(S&& setup, F&& f) {
     std::cout << "Starting" << std::endl;
     auto start_time = std::chrono::steady_clock::now();
+    setup();
+    std::cout << "Setup done. Elapsed " << ElapsedMs(start_time) << " ms" << std::endl;
+    start_time = std::chrono::steady_clock::now();
     f();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                       std::chrono::steady_clock::now() - start_time)
-                       .count();
-    std::cout << "Done. Elapsed " << static_cast<size_t>(elapsed) << " ms" << std::endl;
+    std::cout << "Done. Elapsed " << ElapsedMs(start_time) << " ms" << std::endl;
 }
 
-struct DiskReadRequest {
-    DiskReadRequest(uint64_t disk_idx, uint64_t start_time, uint64_t size)
+struct DiskRequest {
+    DiskRequest(uint64_t disk_idx, uint64_t start_time, uint64_t size)
         : disk_idx(disk_idx), start_time(start_time), size(size) {
     }
 
     uint64_t disk_idx, start_time, size;
+    bool is_write = false;
 };
 
-std::vector<DiskReadRequest> GenerateRequests(uint64_t disks_count, uint64_t requests_count,
-                                              uint64_t max_size, uint64_t max_start_time) {
+std::vector<DiskRequest> GenerateRequests(uint64_t disks_count, uint64_t requests_count,
+                                          uint64_t max_size, uint64_t max_start_time) {
     CustomRandom rnd(16);
 
-    std::vector<DiskReadRequest> requests;
+    std::vector<DiskRequest> requests;
     requests.reserve(requests_count);
 
     for (size_t i = 0; i < requests_count; ++i) {
@@ -82,9 +130,298 @@ std::vector<DiskReadRequest> GenerateRequests(uint64_t disks_count, uint64_t req
     return requests;
 }
 
+// Need to sort for sequential awaiting in `starter` actor and for batching requests by start time
+// in `runner` actor
+void SortRequests(std::vector<DiskRequest>& requests) {
+    std::sort(requests.begin(), requests.end(),
+              [](const DiskRequest& lhs, const DiskRequest& rhs) {
+                  return std::tie(lhs.start_time, lhs.disk_idx, lhs.size) <
+                         std::tie(rhs.start_time, rhs.disk_idx, rhs.size);
+              });
+}
+
+// LSD radix sort of keys with significant bits in [0, key_bits)
+void RadixSort(std::vector<uint64_t>& keys, int key_bits) {
+    static constexpr int kDigitBits = 11;
+    static constexpr size_t kBuckets = size_t{1} << kDigitBits;
+    std::vector<uint64_t> buffer(keys.size());
+    std::vector<size_t> offsets(kBuckets);
+    for (int shift = 0; shift < key_bits; shift += kDigitBits) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (uint64_t key : keys) {
+            ++offsets[(key >> shift) & (kBuckets - 1)];
+        }
+        if (offsets[(keys[0] >> shift) & (kBuckets - 1)] == keys.size()) {
+            continue;  // all keys have the same digit
+        }
+        size_t sum = 0;
+        for (auto& offset : offsets) {
+            sum += std::exchange(offset, sum);
+        }
+        for (uint64_t key : keys) {
+            buffer[offsets[(key >> shift) & (kBuckets - 1)]++] = key;
+        }
+        keys.swap(buffer);
+    }
+}
+
+// Same as GenerateRequests() followed by SortRequests(), but faster for large request counts:
+// random numbers are generated in blocks and requests are sorted by radix sort of packed keys
+// (start_time, disk_idx, size). Requests with equal keys are identical, so the result is exactly
+// the same. Falls back to std::sort if the key does not fit into 64 bits or the disk_idx and size
+// fields take all 64 bits (the packing shifts must be less than 64).
+std::vector<DiskRequest> GenerateSortedRequests(uint64_t disks_count, uint64_t requests_count,
+                                                uint64_t max_size, uint64_t max_start_time) {
+    static constexpr size_t kBlockRequests = 1024;
+    const int disk_bits = std::bit_width(disks_count - 1), size_bits = std::bit_width(max_size),
+              key_bits = std::bit_width(max_start_time) + disk_bits + size_bits;
+
+    CustomRandom rnd(16);
+    std::vector<uint64_t> block(3 * kBlockRequests);
+    auto generate = [&](auto&& emit) {
+        for (size_t first = 0; first < requests_count; first += kBlockRequests) {
+            size_t count = std::min<size_t>(kBlockRequests, requests_count - first);
+            rnd.NextBlock(block.data(), 3 * count);
+            for (size_t i = 0; i < count; ++i) {
+                emit(block[3 * i] % disks_count, block[3 * i + 1] % (max_start_time + 1),
+                     block[3 * i + 2] % (max_size + 1));
+            }
+        }
+    };
+
+    std::vector<DiskRequest> requests;
+    requests.reserve(requests_count);
+    if (key_bits > 64 || disk_bits + size_bits >= 64) {
+        generate([&](uint64_t disk_idx, uint64_t start_time, uint64_t size) {
+            requests.emplace_back(disk_idx, start_time, size);
+        });
+        SortRequests(requests);
+        return requests;
+    }
+
+    std::vector<uint64_t> keys;
+    keys.reserve(requests_count);
+    generate([&](uint64_t disk_idx, uint64_t start_time, uint64_t size) {
+        keys.push_back((((start_time << disk_bits) | disk_idx) << size_bits) | size);
+    });
+    if (!keys.empty()) {
+        RadixSort(keys, key_bits);
+    }
+    const uint64_t disk_mask = (uint64_t{1} << disk_bits) - 1,
+                   size_mask = (uint64_t{1} << size_bits) - 1;
+    for (uint64_t key : keys) {
+        uint64_t size = key & size_mask;
+        key >>= size_bits;
+        requests.emplace_back(key & disk_mask, key >> disk_bits, size);
+    }
+    return requests;
+}
+
+// Makes every second request in start order a write, used by the mixed disk profile
+void MakeMixedRequests(std::vector<DiskRequest>& requests) {
+    for (size_t i = 1; i < requests.size(); i += 2) {
+        requests[i].is_write = true;
+    }
+}
+
+sg4::IoPtr StartIo(DisksSuite* disks_suit, const DiskRequest& req) {
+    if (req.is_write) {
+        return disks_suit->WriteAsync(req.disk_idx, req.size);
+    }
+    return disks_suit->ReadAsync(req.disk_idx, req.size);
+}
+
+const char* DescribeIo(const DiskRequest& req) {
+    return req.is_write ? "write to" : "read from";
+}
+
+void LogRequestStart(size_t request_id, const DiskRequest& req) {
+    XBT_INFO("Starting request #%lu: %s disk-%lu, size = %lu, expected start time = %.3f",
+             request_id, DescribeIo(req), req.disk_idx, req.size,
+             static_cast<double>(req.start_time));
+}
+
+void LogRequestCompletion(size_t request_id, const DiskRequest& req, double elapsed_time) {
+    XBT_INFO("Completed request #%lu: %s disk-%lu, size = %lu, elapsed simulation time = %.3f",
+             request_id, DescribeIo(req), req.disk_idx, req.size, elapsed_time);
+}
+
+// Wakes up the runner at the start time of each request
+void RunStarter(sg4::Mailbox* mb, const std::vector<DiskRequest>& requests) {
+    static int start_signal = 0;
+    for (const auto& req : requests) {
+        sg4::this_actor::sleep_until(req.start_time);
+        mb->put(&start_signal, 0);
+    }
+}
+
+// Starts next request each time a message from starter is received
+void RunWithStarter(sg4::Mailbox* mb, DisksSuite* disks_suit,
+                    const std::vector<DiskRequest>& requests) {
+    XBT_INFO("Starting disk benchmark");
+
+    std::vector<sg4::ActivityPtr> activities;
+    int* dummy = nullptr;
+    activities.push_back(mb->get_async<int>(&dummy));
+
+    size_t next_activity_to_start = 0;
+    std::vector<size_t> activities_to_requests;
+    activities_to_requests.push_back(0);  // dummy
+
+    std::vector<double> real_start_times;
+    real_start_times.resize(requests.size());
+
+    for (size_t i = 0; i < 2 * requests.size(); ++i) {
+        if (size_t finished_idx = sg4::Activity::wait_any(activities); finished_idx == 0) {
+            // Time to start next disk activity
+            auto& req = requests[next_activity_to_start];
+
+            activities.emplace_back(StartIo(disks_suit, req));
+            activities_to_requests.push_back(next_activity_to_start);
+            real_start_times[next_activity_to_start] = sg4::Engine::get_clock();
+
+            LogRequestStart(next_activity_to_start, req);
+            ++next_activity_to_start;
+
+            activities[0] = mb->get_async<int>(&dummy);
+        } else {
+            // Some disk activity completed
+            size_t request_id = activities_to_requests[finished_idx];
+            auto& req = requests[request_id];
+
+            LogRequestCompletion(request_id, req,
+                                 sg4::Engine::get_clock() - real_start_times[request_id]);
+
+            std::swap(activities[finished_idx], activities.back());
+            std::swap(activities_to_requests[finished_idx], activities_to_requests.back());
+            activities.pop_back();
+            activities_to_requests.pop_back();
+        }
+    }
+    XBT_INFO("Exit");
+}
+
+// Starts all requests with the same start time at once. The next start time is used as the
+// timeout when waiting for disk activities, so no starter actor and mailbox are needed.
+void RunBatched(DisksSuite* disks_suit, const std::vector<DiskRequest>& requests) {
+    XBT_INFO("Starting disk benchmark");
+
+    std::vector<sg4::ActivityPtr> activities;
+    std::vector<size_t> activities_to_requests;
+    std::vector<double> real_start_times(requests.size());
+
+    size_t next_request = 0;
+    auto start_batch = [&] {
+        uint64_t start_time = requests[next_request].start_time;
+        double now = sg4::Engine::get_clock();
+        for (; next_request < requests.size() && requests[next_request].start_time == start_time;
+             ++next_request) {
+            auto& req = requests[next_request];
+            activities.emplace_back(StartIo(disks_suit, req));
+            activities_to_requests.push_back(next_request);
+            real_start_times[next_request] = now;
+            LogRequestStart(next_request, req);
+        }
+    };
+
+    while (next_request < requests.size() || !activities.empty()) {
+        if (activities.empty()) {
+            sg4::this_actor::sleep_until(requests[next_request].start_time);
+            start_batch();
+            continue;
+        }
+        double timeout = -1;  // wait for completion only
+        if (next_request < requests.size()) {
+            timeout = requests[next_request].start_time - sg4::Engine::get_clock();
+            if (timeout <= 0) {
+                start_batch();
+                continue;
+            }
+        }
+        ssize_t finished_idx = sg4::Activity::wait_any_for(activities, timeout);
+        if (finished_idx < 0) {
+            // Time to start next batch
+            start_batch();
+            continue;
+        }
+        size_t request_id = activities_to_requests[finished_idx];
+        LogRequestCompletion(request_id, requests[request_id],
+                             sg4::Engine::get_clock() - real_start_times[request_id]);
+
+        std::swap(activities[finished_idx], activities.back());
+        std::swap(activities_to_requests[finished_idx], activities_to_requests.back());
+        activities.pop_back();
+        activities_to_requests.pop_back();
+    }
+    XBT_INFO("Exit");
+}
+
+// Completions are handled by a callback connected to the activity completion signal, which finds
+// the request via the user data of the activity pointing into a preallocated table indexed by
+// request id, so handling a completion does not depend on the number of in-flight requests.
+// Requests are started either on messages from starter (mb != nullptr) or in batches by start time,
+// then runner waits for all activities in request order.
+void RunWithCallbacks(sg4::Mailbox* mb, DisksSuite* disks_suit,
+                      const std::vector<DiskRequest>& requests) {
+    XBT_INFO("Starting disk benchmark");
+
+    struct RequestState {
+        sg4::IoPtr activity;
+        double real_start_time = 0.;
+    };
+    std::vector<RequestState> states(requests.size());
+
+    // the signal is global, so the callback ignores the activities which are not started here and
+    // is disconnected before the locals it refers to are destroyed
+    auto log_completion = [&states, &requests](const sg4::Activity& activity) {
+        const auto* io = dynamic_cast<const sg4::Io*>(&activity);
+        if (io == nullptr) {
+            return;
+        }
+        const auto* state = static_cast<const RequestState*>(io->get_user_data());
+        if (std::less<>()(state, states.data()) ||
+            !std::less<>()(state, states.data() + states.size())) {
+            return;
+        }
+        size_t request_id = state - states.data();
+        LogRequestCompletion(request_id, requests[request_id],
+                             sg4::Engine::get_clock() - state->real_start_time);
+    };
+    unsigned int connection = sg4::Activity::on_completion.connect(log_completion);
+
+    auto start_request = [&](size_t request_id) {
+        auto& req = requests[request_id];
+        auto& state = states[request_id];
+        state.real_start_time = sg4::Engine::get_clock();
+        state.activity = StartIo(disks_suit, req);
+        state.activity->set_user_data(&state);
+        LogRequestStart(request_id, req);
+    };
+
+    if (mb != nullptr) {
+        for (size_t request_id = 0; request_id < requests.size(); ++request_id) {
+            mb->get<int>();
+            start_request(request_id);
+        }
+    } else {
+        for (size_t request_id = 0; request_id < requests.size(); ++request_id) {
+            sg4::this_actor::sleep_until(requests[request_id].start_time);
+            start_request(request_id);
+        }
+    }
+
+    // Waiting for an already completed activity returns immediately, so the total cost is linear
+    for (auto& state : states) {
+        state.activity->wait();
+    }
+    sg4::Activity::on_completion.disconnect(connection);
+    XBT_INFO("Exit");
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
+    RunStats run_stats("storage");
     sg4::Engine e(&argc, argv);
 
     argparse::ArgumentParser parser("simulator");
@@ -117,8 +454,40 @@ int main(int argc, char** argv) {
         .action(str_to_ull)
         .default_value(kDefaultMaxStartTime);
 
+    parser.add_argument("--start-mode")
+        .help("How requests are started: mailbox (starter actor wakes up runner for each request) "
+              "or batch (runner starts all requests with the same start time at once)")
+        .nargs(1)
+        .default_value(std::string("mailbox"));
+
+    parser.add_argument("--completion-mode")
+        .help("How completions are handled: wait-any (runner waits for any of in-flight "
+              "activities) or callback (activity completion signal is used)")
+        .nargs(1)
+        .default_value(std::string("wait-any"));
+
+    parser.add_argument("--disk-profile")
+        .help("Disk model: linear (LINEAR sharing), degradation (NONLINEAR sharing with capacity "
+              "degradation), size-bandwidth (bandwidth depends on request size via factor "
+              "callback) or mixed (linear, every second request is a write)")
+        .nargs(1)
+        .default_value(std::string("linear"));
+
+    parser.add_argument("--instrument")
+        .help("Collect activity, solver round and context switch counters and print a summary")
+        .default_value(false)
+        .implicit_value(true);
+
+    parser.add_argument("--reference-generation")
+        .help("Generate requests one by one and sort them with std::sort instead of the fast "
+              "block generation and radix sort (the result is the same)")
+        .default_value(false)
+        .implicit_value(true);
+
     uint64_t requests_count = kDefaultRequestsCount, disks_count = kDefaultDisksCount,
              max_size = kDefaultMaxSize, max_start_time = kDefaultMaxStartTime;
+    std::string start_mode, completion_mode, disk_profile;
+    bool reference_generation = false, instrument = false;
     try {
         parser.parse_args(argc, argv);
 
@@ -126,86 +495,85 @@ int main(int argc, char** argv) {
         disks_count = parser.get<uint64_t>("--disks");
         max_size = parser.get<uint64_t>("--max-size");
         max_start_time = parser.get<uint64_t>("--max-start-time");
+        start_mode = parser.get<std::string>("--start-mode");
+        if (start_mode != "mailbox" && start_mode != "batch") {
+            throw std::runtime_error("unknown start mode: " + start_mode);
+        }
+        completion_mode = parser.get<std::string>("--completion-mode");
+        if (completion_mode != "wait-any" && completion_mode != "callback") {
+            throw std::runtime_error("unknown completion mode: " + completion_mode);
+        }
+        disk_profile = parser.get<std::string>("--disk-profile");
+        if (disk_profile != "linear" && disk_profile != "degradation" &&
+            disk_profile != "size-bandwidth" && disk_profile != "mixed") {
+            throw std::runtime_error("unknown disk profile: " + disk_profile);
+        }
+        reference_generation = parser.get<bool>("--reference-generation");
+        instrument = parser.get<bool>("--instrument");
     } catch (const std::runtime_error& re) {
         std::cerr << "Argument parse error: " << re.what() << "\n";
         std::cerr << parser << "\n";
         std::exit(1);
     }
 
-    auto* zone = sg4::create_full_zone("sample_zone");
-    auto* host = zone->create_host("sample_host", 1e6);
-
-    auto disks_suit = MakeSimpleDisks(host, disks_count);
-
-    zone->seal();
+    std::optional<Instrumentation> instrumentation;
+    if (instrument) {
+        instrumentation.emplace();
+    }
 
-    auto* mb = sg4::Mailbox::by_name("");
+    std::unique_ptr<DisksSuite> disks_suit;
+    std::vector<DiskRequest> requests;
+    auto setup = [&] {
+        auto* zone = sg4::create_full_zone("sample_zone");
+        auto* host = zone->create_host("sample_host", 1e6);
 
-    auto requests = GenerateRequests(disks_count, requests_count, max_size, max_start_time);
+        disks_suit = MakeDisksWithProfile(disk_profile, host, disks_count);
 
-    // Need to sort for sequential awaiting in `starter` actor
-    std::sort(requests.begin(), requests.end(),
-              [](const DiskReadRequest& lhs, const DiskReadRequest& rhs) {
-                  return std::tie(lhs.start_time, lhs.disk_idx, lhs.size) <
-                         std::tie(rhs.start_time, rhs.disk_idx, rhs.size);
-              });
+        zone->seal();
 
-    sg4::Actor::create("starter", host, [&] {
-        for (const auto& req : requests) {
-            sg4::this_actor::sleep_until(req.start_time);
-            mb->put(new int, 0);
+        if (reference_generation) {
+            requests = GenerateRequests(disks_count, requests_count, max_size, max_start_time);
+            SortRequests(requests);
+        } else {
+            requests =
+                GenerateSortedRequests(disks_count, requests_count, max_size, max_start_time);
+        }
+        if (disk_profile == "mixed") {
+            MakeMixedRequests(requests);
         }
-    });
-
-    sg4::Actor::create("runner", host, [&] {
-        XBT_INFO("Starting disk benchmark");
-
-        std::vector<sg4::ActivityPtr> activities;
-        int* dummy = nullptr;
-        activities.push_back(mb->get_async<int>(&dummy));
-
-        size_t next_activity_to_start = 0;
-        std::vector<size_t> activities_to_requests;
-        activities_to_requests.push_back(0);  // dummy
-
-        std::vector<double> real_start_times;
-        real_start_times.resize(requests_count);
-
-        for (size_t i = 0; i < 2 * requests_count; ++i) {
-            if (size_t finished_idx = sg4::Activity::wait_any(activities); finished_idx == 0) {
-                // Time to start next disk activity
-                auto& req = requests[next_activity_to_start];
-
-                activities.emplace_back(disks_suit->ReadAsync(req.disk_idx, req.size));
-                activities_to_requests.push_back(next_activity_to_start);
-                real_start_times[next_activity_to_start] = sg4::Engine::get_clock();
-
-                XBT_INFO(
-                    "Starting request #%lu: read from disk-%lu, size = %lu, expected start time = "
-                    "%.3f",
-                    next_activity_to_start, req.disk_idx, req.size,
-                    static_cast<double>(req.start_time));
-                ++next_activity_to_start;
 
-                activities[0] = mb->get_async<int>(&dummy);
+        if (start_mode == "batch") {
+            if (completion_mode == "callback") {
+                sg4::Actor::create("runner", host,
+                                   [&] { RunWithCallbacks(nullptr, disks_suit.get(), requests); });
+            } else {
+                sg4::Actor::create("runner", host, [&] { RunBatched(disks_suit.get(), requests); });
+            }
+        } else {
+            auto* mb = sg4::Mailbox::by_name("");
+            sg4::Actor::create("starter", host, [&, mb] { RunStarter(mb, requests); });
+            if (completion_mode == "callback") {
+                sg4::Actor::create("runner", host,
+                                   [&, mb] { RunWithCallbacks(mb, disks_suit.get(), requests); });
             } else {
-                // Some disk activity completed
-                size_t request_id = activities_to_requests[finished_idx];
-                auto& req = requests[request_id];
-
-                double elapsed_time = sg4::Engine::get_clock() - real_start_times[request_id];
-                XBT_INFO(
-                    "Completed request #%lu: read from disk-%lu, size = %lu, elapsed simulation "
-                    "time = %.3f",
-                    request_id, req.disk_idx, req.size, elapsed_time);
-
-                std::swap(activities[finished_idx], activities.back());
-                std::swap(activities_to_requests[finished_idx], activities_to_requests.back());
-                activities.pop_back();
-                activities_to_requests.pop_back();
+                sg4::Actor::create("runner", host,
+                                   [&, mb] { RunWithStarter(mb, disks_suit.get(), requests); });
             }
         }
-        XBT_INFO("Exit");
+        run_stats.SetupDone();
+    };
+    RunWithTimeMeasure(setup, [&] {
+        if (instrumentation) {
+            instrumentation->RunStarted();
+        }
+        e.run();
+        if (instrumentation) {
+            instrumentation->RunDone();
+        }
     });
-    RunWithTimeMeasure([&e] { e.run(); });
+    run_stats.RunDone(e.get_clock(), requests_count);
+    if (instrumentation) {
+        instrumentation->Print();
+    }
+    run_stats.Print();
 }
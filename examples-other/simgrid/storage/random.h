@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <utility>
 
 class CustomRandom {
 public:
@@ -18,8 +20,34 @@ public:
         return seed_;
     }
 
+    // Fills out[0..n) with the same values as n calls of Next(). The sequence is split into kLanes
+    // interleaved subsequences advanced with jump-ahead step x[i + kLanes] = A' * x[i] + B', so
+    // consecutive values do not depend on each other and can be computed in parallel.
+    void NextBlock(uint64_t* out, size_t n) {
+        size_t i = 0;
+        for (; i < n && i < kLanes; ++i) {
+            out[i] = Next();
+        }
+        for (; i < n; ++i) {
+            out[i] = (kJump.first * out[i - kLanes] + kJump.second) % kMod;
+        }
+        if (n > kLanes) {
+            seed_ = out[n - 1];
+        }
+    }
+
 private:
     uint64_t seed_;
 
     static inline constexpr uint64_t kA = 737687, kB = 65916437, kMod = 1e9 + 7;
+    static inline constexpr size_t kLanes = 8;
+    // (A', B') such that kLanes calls of Next() transform state x into A' * x + B'
+    static inline constexpr std::pair<uint64_t, uint64_t> kJump = [] {
+        uint64_t a = 1, b = 0;
+        for (size_t i = 0; i < kLanes; ++i) {
+            a = a * kA % kMod;
+            b = (b * kA + kB) % kMod;
+        }
+        return std::pair{a, b};
+    }();
 };
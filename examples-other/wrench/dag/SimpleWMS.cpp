@@ -7,7 +7,14 @@
  * (at your option) any later version.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <limits>
+
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
 
 #include "SimpleWMS.h"
 
@@ -24,16 +31,69 @@ namespace wrench {
      * @param cloud_compute_service: a cloud compute service available to run jobs
      * @param storage_service: a storage service available to store files
      * @param hostname: the name of the host on which to start the WMS
+     * @param online_stats: whether to accumulate task completion statistics during the execution
+     * @param scheduler_type: the policy of scheduling ready tasks
+     * @param local_storage_services: storage services on compute hosts (by hostname) for intermediate files,
+     *                                which are used only with the HEFT scheduler
+     * @param autoscaling: whether to start and release VMs and pilot jobs depending on the ready tasks instead of
+     *                     using two VMs and a pilot job of 2 nodes
      */
     SimpleWMS::SimpleWMS(const std::shared_ptr<Workflow> &workflow,
                          const std::shared_ptr<BatchComputeService> &batch_compute_service,
                          const std::shared_ptr<CloudComputeService> &cloud_compute_service,
                          const std::shared_ptr<StorageService> &storage_service,
-                         const std::string &hostname) : ExecutionController(hostname, "simple"),
-                                                        workflow(workflow),
-                                                        batch_compute_service(batch_compute_service),
-                                                        cloud_compute_service(cloud_compute_service),
-                                                        storage_service(storage_service) {}
+                         const std::string &hostname,
+                         bool online_stats,
+                         SchedulerType scheduler_type,
+                         const std::map<std::string, std::shared_ptr<StorageService>> &local_storage_services,
+                         bool autoscaling)
+                         : ExecutionController(hostname, "simple"),
+                           workflow(workflow),
+                           batch_compute_service(batch_compute_service),
+                           cloud_compute_service(cloud_compute_service),
+                           storage_service(storage_service),
+                           online_stats(online_stats),
+                           scheduler_type(scheduler_type),
+                           local_storage_services(local_storage_services),
+                           autoscaling(autoscaling) {}
+
+    /**
+     * @brief Get the total wall-clock time spent in scheduleReadyTasks
+     *
+     * @return time in seconds
+     */
+    double SimpleWMS::getSchedulingTime() const {
+        return this->scheduling_time;
+    }
+
+    /**
+     * @brief Get task completion statistics, which are collected only with online_stats enabled
+     *
+     * @return statistics over the tasks completed so far
+     */
+    const TaskCompletionStats &SimpleWMS::getTaskCompletionStats() const {
+        return this->task_completion_stats;
+    }
+
+    /**
+     * @brief Get the number of bytes of task input/output files read or written over the network by completed
+     *        tasks, i.e. files on a storage service that is not on the physical host of the task
+     *
+     * @return number of bytes
+     */
+    double SimpleWMS::getNumBytesTransferred() const {
+        return this->num_bytes_transferred;
+    }
+
+    /**
+     * @brief Get the number of core-hours of the VMs and pilot jobs used until the end of the workflow execution,
+     *        counted from the VM or pilot job start
+     *
+     * @return number of core-hours
+     */
+    double SimpleWMS::getCoreHoursUsed() const {
+        return this->core_seconds_used / 3600;
+    }
 
     /**
      * @brief main method of the SimpleWMS daemon
@@ -55,38 +115,69 @@ namespace wrench {
         // Create a data movement manager
         auto data_movement_manager = this->createDataMovementManager();
 
-        // Create and start two VMs on the cloud service to use for the whole execution
-        auto vm1 = this->cloud_compute_service->createVM(4, 0.0);// 4 cores, 0 RAM (RAM isn't used in this simulation)
-        auto vm1_cs = this->cloud_compute_service->startVM(vm1);
-        this->core_utilization_map[vm1_cs] = 4;
+        if (this->autoscaling) {
+            // VMs and pilot jobs are started by autoscale depending on the ready tasks
+            for (auto const &[hostname, num_cores]: this->cloud_compute_service->getPerHostNumCores()) {
+                this->max_num_vms += num_cores / VM_NUM_CORES;
+            }
+            auto batch_node_cores = this->batch_compute_service->getPerHostNumCores();
+            this->num_batch_nodes = batch_node_cores.size();
+            this->batch_node_num_cores = std::numeric_limits<unsigned long>::max();
+            for (auto const &[hostname, num_cores]: batch_node_cores) {
+                this->batch_node_num_cores = std::min(this->batch_node_num_cores, num_cores);
+            }
+            this->batch_core_flop_rate = this->batch_compute_service->getCoreFlopRate().begin()->second;
+        } else {
+            // Create and start two VMs on the cloud service to use for the whole execution
+            this->addVM(VM_NUM_CORES);
+            this->addVM(VM_NUM_CORES);
+        }
 
-        auto vm2 = this->cloud_compute_service->createVM(4, 0.0);// 4 cores, 0 RAM (RAM isn't used in this simulation)
-        auto vm2_cs = this->cloud_compute_service->startVM(vm2);
-        this->core_utilization_map[vm2_cs] = 4;
+        // All files are read/written from the one storage service, so a single location is shared
+        this->storage_service_location = FileLocation::LOCATION(this->storage_service);
 
+        // The HEFT scheduler keeps intermediate files on the storage services of compute hosts and orders
+        // ready tasks by upward rank, which is computed once for the whole workflow
+        if (this->scheduler_type == SchedulerType::HEFT) {
+            for (auto const &[host, ss]: this->local_storage_services) {
+                this->local_storage_locations[host] = FileLocation::LOCATION(ss);
+            }
+            this->computeUpwardRanks();
+        }
+
+        // Ready tasks are tracked incrementally as jobs complete, starting from the entry tasks
+        for (auto const &task: this->workflow->getReadyTasks()) {
+            this->enqueueReadyTask(task);
+        }
 
         while (true) {
 
-            // If a pilot job is not running on the batch service, let's submit one that asks
-            // for 10 cores on 2 compute nodes for 24 hours
-            if (not pilot_job) {
+            if (this->autoscaling) {
+                this->autoscale(job_manager);
+            } else if (not pilot_job) {
+                // If a pilot job is not running on the batch service, let's submit one that asks
+                // for 10 cores on 2 compute nodes for 24 hours
                 WRENCH_INFO("Creating and submitting a pilot job");
                 pilot_job = job_manager->createPilotJob();
+                this->num_pilot_job_cores = 20;
                 job_manager->submitJob(pilot_job, this->batch_compute_service,
                                        {{"-N", "2"}, {"-c", "10"}, {"-t", "1440"}});
             }
 
-            // Construct the list of currently available bare-metal services (on VMs and perhaps within pilot job as well)
-            std::set<std::shared_ptr<BareMetalComputeService>> available_compute_service = {vm1_cs, vm2_cs};
-            if (this->pilot_job_is_running) {
-                available_compute_service.insert(pilot_job->getComputeService());
+            // The list of available bare-metal services is updated when the pilot job starts or expires
+            if (this->scheduler_type == SchedulerType::HEFT) {
+                scheduleRankedReadyTasks(job_manager);
+            } else {
+                scheduleReadyTasks(job_manager);
             }
 
-            scheduleReadyTasks(workflow->getReadyTasks(), job_manager, available_compute_service);
-
-            // Wait for a workflow execution event, and process it
+            // Wait for a workflow execution event, and process it (with autoscaling, or until the next decision)
             try {
-                this->waitForAndProcessNextEvent();
+                if (this->autoscaling) {
+                    this->waitForAndProcessNextEvent(AUTOSCALING_INTERVAL);
+                } else {
+                    this->waitForAndProcessNextEvent();
+                }
             } catch (ExecutionException &e) {
                 WRENCH_INFO("Error while getting next execution event (%s)... ignoring and trying again",
                             (e.getCause()->toString().c_str()));
@@ -97,6 +188,11 @@ namespace wrench {
             }
         }
 
+        // The resources are accounted until the end of the workflow execution
+        while (not this->leases.empty()) {
+            this->endLease(this->leases.begin()->first);
+        }
+
         S4U_Simulation::sleep(10);
 
         WRENCH_INFO("--------------------------------------------------------");
@@ -122,6 +218,13 @@ namespace wrench {
         WRENCH_INFO("Task %s has failed", (*job->getTasks().begin())->getID().c_str());
         WRENCH_INFO("failure cause: %s", event->failure_cause->toString().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
+        // The failed tasks become ready again and should be resubmitted
+        for (auto const &task: job->getTasks()) {
+            this->releaseExecutionHost(task);
+            if (task->getState() == WorkflowTask::State::READY) {
+                this->enqueueReadyTask(task);
+            }
+        }
     }
 
     /**
@@ -136,7 +239,39 @@ namespace wrench {
                     (*job->getTasks().begin())->getID().c_str(),
                     job->getParentComputeService()->getName().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
-        this->core_utilization_map[job->getParentComputeService()]++;
+        auto cs = job->getParentComputeService();
+        // The service is not available anymore if the pilot job has expired
+        auto idle_cores = this->core_utilization_map.find(cs);
+        if (this->scheduler_type == SchedulerType::NAIVE and idle_cores != this->core_utilization_map.end()) {
+            this->setNumIdleCores(cs, idle_cores->second + 1);
+        }
+        // Only children of the completed tasks can become ready
+        for (auto const &task: job->getTasks()) {
+            this->releaseExecutionHost(task);
+            this->addNumBytesTransferred(task);
+            double duration = task->getEndDate() - task->getStartDate();
+            this->recent_task_duration = this->recent_task_duration > 0
+                                                 ? (1 - TASK_DURATION_WEIGHT) * this->recent_task_duration + TASK_DURATION_WEIGHT * duration
+                                                 : duration;
+            if (this->online_stats) {
+                const auto &history = task->getExecutionHistory();
+                auto const &execution = history.top();
+                double io_time = execution.read_input_end - execution.read_input_start;
+                io_time += execution.write_output_end - execution.write_output_start;
+                double compute_time = execution.computation_end - execution.computation_start;
+                this->task_completion_stats.num_completed_tasks++;
+                if (history.size() > 1) {
+                    this->task_completion_stats.num_failed_tasks++;
+                }
+                this->task_completion_stats.computation_communication_ratio_sum += compute_time / io_time;
+            }
+            this->file_locations_cache.erase(task);
+            for (auto const &child: task->getChildren()) {
+                if (child->getState() == WorkflowTask::State::READY) {
+                    this->enqueueReadyTask(child);
+                }
+            }
+        }
     }
 
 
@@ -150,8 +285,16 @@ namespace wrench {
         WRENCH_INFO("The pilot job has started (it exposes bare-metal compute service %s)",
                     event->pilot_job->getComputeService()->getName().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
+
+        // A pilot job terminated by autoscale before its start is already released
+        if (event->pilot_job != this->pilot_job) {
+            return;
+        }
         this->pilot_job_is_running = true;
-        this->core_utilization_map[this->pilot_job->getComputeService()] = event->pilot_job->getComputeService()->getTotalNumIdleCores();
+        this->compute_services.push_back(this->pilot_job->getComputeService());
+        this->setNumIdleCores(this->pilot_job->getComputeService(), event->pilot_job->getComputeService()->getTotalNumIdleCores());
+        this->addExecutionHosts(this->pilot_job->getComputeService());
+        this->startLease(this->pilot_job->getComputeService(), this->pilot_job->getComputeService()->getTotalNumIdleCores());
     }
 
     /**
@@ -165,11 +308,417 @@ namespace wrench {
                     event->pilot_job->getComputeService()->getName().c_str());
         TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_GREEN);
 
+        // A pilot job terminated by autoscale is already released
+        if (event->pilot_job != this->pilot_job) {
+            return;
+        }
         this->pilot_job_is_running = false;
-        this->core_utilization_map.erase(this->pilot_job->getComputeService());
+        this->removeComputeService(this->pilot_job->getComputeService());
         this->pilot_job = nullptr;
     }
 
+    /**
+     * @brief Start a VM on the cloud compute service and make it available for tasks
+     *
+     * @param num_cores: the number of VM cores
+     */
+    void SimpleWMS::addVM(unsigned long num_cores) {
+        auto vm = this->cloud_compute_service->createVM(num_cores, 0.0);// 0 RAM (RAM isn't used in this simulation)
+        auto vm_cs = this->cloud_compute_service->startVM(vm);
+        this->compute_services.push_back(vm_cs);
+        this->setNumIdleCores(vm_cs, num_cores);
+        this->addExecutionHosts(vm_cs, vm);
+        this->vm_names[vm_cs] = vm;
+        this->startLease(vm_cs, num_cores);
+    }
+
+    /**
+     * @brief Forget a compute service of an expired or terminated pilot job or of a shut down VM
+     *
+     * @param cs: a compute service
+     */
+    void SimpleWMS::removeComputeService(const std::shared_ptr<BareMetalComputeService> &cs) {
+        this->compute_services.erase(std::remove(this->compute_services.begin(), this->compute_services.end(), cs),
+                                     this->compute_services.end());
+        this->core_utilization_map.erase(cs);
+        this->idle_compute_services.erase(cs);
+        for (auto it = this->execution_hosts.begin(); it != this->execution_hosts.end();) {
+            if (it->second.compute_service == cs) {
+                it = this->execution_hosts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        this->vm_names.erase(cs);
+        this->idle_since.erase(cs);
+        this->endLease(cs);
+    }
+
+    /**
+     * @brief Get the number of idle cores of a compute service, as tracked by the current scheduler
+     *
+     * @param cs: a compute service
+     * @return the number of cores that are not used by submitted tasks
+     */
+    unsigned long SimpleWMS::getNumIdleCores(const std::shared_ptr<BareMetalComputeService> &cs) {
+        if (this->scheduler_type == SchedulerType::HEFT) {
+            unsigned long num_idle_cores = 0;
+            for (auto const &[hostname, host]: this->execution_hosts) {
+                if (host.compute_service == cs) {
+                    num_idle_cores += host.num_idle_cores;
+                }
+            }
+            return num_idle_cores;
+        }
+        auto it = this->core_utilization_map.find(cs);
+        return it != this->core_utilization_map.end() ? it->second : 0;
+    }
+
+    /**
+     * @brief Estimate the duration of a ready task: the moving average of completed task durations, or the average
+     *        computation time of the ready tasks on a batch node core before any task completes
+     *
+     * @return duration in seconds
+     */
+    double SimpleWMS::estimateTaskDuration() const {
+        if (this->recent_task_duration > 0 or this->queued_tasks.empty()) {
+            return this->recent_task_duration;
+        }
+        double flops = 0;
+        for (auto const &task: this->queued_tasks) {
+            flops += task->getFlops();
+        }
+        return flops / (double) this->queued_tasks.size() / this->batch_core_flop_rate;
+    }
+
+    /**
+     * @brief Start accounting the cores of a VM or pilot job
+     *
+     * @param cs: the compute service of the VM or pilot job
+     * @param num_cores: the number of cores
+     */
+    void SimpleWMS::startLease(const std::shared_ptr<BareMetalComputeService> &cs, unsigned long num_cores) {
+        this->leases[cs] = {Simulation::getCurrentSimulatedDate(), num_cores};
+    }
+
+    /**
+     * @brief Stop accounting the cores of a VM or pilot job and add them to the used core-hours
+     *
+     * @param cs: the compute service of the VM or pilot job
+     */
+    void SimpleWMS::endLease(const std::shared_ptr<BareMetalComputeService> &cs) {
+        auto it = this->leases.find(cs);
+        if (it == this->leases.end()) {
+            return;
+        }
+        auto [start_date, num_cores] = it->second;
+        this->core_seconds_used += (Simulation::getCurrentSimulatedDate() - start_date) * (double) num_cores;
+        this->leases.erase(it);
+    }
+
+    /**
+     * @brief Start and release VMs and pilot jobs depending on the ready tasks and the recent task durations.
+     *
+     *        The wanted number of cores is the number of cores needed to run the ready tasks within
+     *        max(task duration, AUTOSCALING_INTERVAL), so a backlog of long tasks gets a core per task, while short
+     *        tasks are mostly left to the cores that become idle soon. Missing cores are first added as VMs, which
+     *        start right away, and the rest is requested as a pilot job sized to the backlog, with a time limit of
+     *        PILOT_JOB_TIME_LIMIT_FACTOR times the estimated time to run its share of the ready tasks. VMs and the pilot
+     *        job are released when there are no ready tasks and all their cores have been idle for
+     *        max(2 * AUTOSCALING_INTERVAL, task duration), a pilot job which has not started yet is cancelled as soon
+     *        as there are no ready tasks.
+     *
+     * @param job_manager: a job manager
+     */
+    void SimpleWMS::autoscale(const std::shared_ptr<JobManager> &job_manager) {
+        double now = Simulation::getCurrentSimulatedDate();
+        double task_duration = this->estimateTaskDuration();
+        unsigned long num_ready_tasks = this->queued_tasks.size();
+
+        if (num_ready_tasks > 0) {
+            this->idle_since.clear();
+            unsigned long num_idle_cores = 0;
+            for (auto const &cs: this->compute_services) {
+                num_idle_cores += this->getNumIdleCores(cs);
+            }
+            if (this->pilot_job and not this->pilot_job_is_running) {
+                num_idle_cores += this->num_pilot_job_cores;
+            }
+            double drain_time = std::max(task_duration, AUTOSCALING_INTERVAL);
+            auto num_wanted_cores = std::min(
+                    num_ready_tasks, std::max(1UL, (unsigned long) std::ceil((double) num_ready_tasks * task_duration / drain_time)));
+            if (num_wanted_cores <= num_idle_cores) {
+                return;
+            }
+            unsigned long num_missing_cores = num_wanted_cores - num_idle_cores;
+
+            while (num_missing_cores > 0 and this->vm_names.size() < this->max_num_vms) {
+                WRENCH_INFO("Starting a VM for %lu ready tasks", num_ready_tasks);
+                try {
+                    this->addVM(VM_NUM_CORES);
+                } catch (ExecutionException &e) {
+                    WRENCH_INFO("WARNING: Was not able to start a VM (%s)", e.getCause()->toString().c_str());
+                    break;
+                }
+                num_missing_cores -= std::min(num_missing_cores, VM_NUM_CORES);
+            }
+
+            if (num_missing_cores > 0 and not this->pilot_job) {
+                unsigned long num_nodes = std::min(this->num_batch_nodes,
+                                                   (num_missing_cores + this->batch_node_num_cores - 1) / this->batch_node_num_cores);
+                this->num_pilot_job_cores = num_nodes * this->batch_node_num_cores;
+                // The ready tasks are shared by the pilot job and the cores which are idle or added as VMs
+                auto num_cores = num_wanted_cores - num_missing_cores + this->num_pilot_job_cores;
+                double run_time = std::max(task_duration, (double) num_ready_tasks * task_duration / (double) num_cores);
+                auto num_minutes = (unsigned long) std::ceil(PILOT_JOB_TIME_LIMIT_FACTOR * run_time / 60);
+                WRENCH_INFO("Creating and submitting a pilot job for %lu nodes and %lu minutes", num_nodes, num_minutes);
+                this->pilot_job = job_manager->createPilotJob();
+                job_manager->submitJob(this->pilot_job, this->batch_compute_service,
+                                       {{"-N", std::to_string(num_nodes)},
+                                        {"-c", std::to_string(this->batch_node_num_cores)},
+                                        {"-t", std::to_string(std::max(num_minutes, 1UL))}});
+            }
+            return;
+        }
+
+        // A pending pilot job would only start to sit idle, so it is cancelled
+        if (this->pilot_job and not this->pilot_job_is_running) {
+            WRENCH_INFO("Terminating pending pilot job");
+            job_manager->terminateJob(this->pilot_job);
+            this->pilot_job = nullptr;
+        }
+
+        double idle_timeout = std::max(2 * AUTOSCALING_INTERVAL, task_duration);
+        auto compute_services = this->compute_services;
+        for (auto const &cs: compute_services) {
+            auto lease = this->leases.find(cs);
+            if (lease == this->leases.end() or this->getNumIdleCores(cs) < lease->second.second) {
+                this->idle_since.erase(cs);
+                continue;
+            }
+            auto [it, inserted] = this->idle_since.try_emplace(cs, now);
+            if (now - it->second < idle_timeout) {
+                continue;
+            }
+            auto vm = this->vm_names.find(cs);
+            if (vm != this->vm_names.end()) {
+                WRENCH_INFO("Shutting down idle VM %s", vm->second.c_str());
+                auto vm_name = vm->second;
+                this->removeComputeService(cs);
+                this->cloud_compute_service->shutdownVM(vm_name);
+                this->cloud_compute_service->destroyVM(vm_name);
+            } else if (this->pilot_job and cs == this->pilot_job->getComputeService()) {
+                WRENCH_INFO("Terminating idle pilot job");
+                this->removeComputeService(cs);
+                job_manager->terminateJob(this->pilot_job);
+                this->pilot_job = nullptr;
+                this->pilot_job_is_running = false;
+            }
+        }
+    }
+
+    /**
+     * @brief Add a task to the ready queue unless it is already there
+     *
+     * @param task: a ready task
+     */
+    void SimpleWMS::enqueueReadyTask(const std::shared_ptr<WorkflowTask> &task) {
+        if (this->queued_tasks.insert(task).second) {
+            if (this->scheduler_type == SchedulerType::HEFT) {
+                this->ranked_ready_tasks.emplace(this->upward_ranks[task], task);
+            } else {
+                this->ready_tasks.insert(task);
+            }
+        }
+    }
+
+    /**
+     * @brief Update the number of idle cores of a compute service and the index of services with idle cores
+     *
+     * @param cs: a compute service
+     * @param num_idle_cores: the number of idle cores
+     */
+    void SimpleWMS::setNumIdleCores(const std::shared_ptr<ComputeService> &cs, unsigned long num_idle_cores) {
+        this->core_utilization_map[cs] = num_idle_cores;
+        auto bare_metal_cs = std::dynamic_pointer_cast<BareMetalComputeService>(cs);
+        if (num_idle_cores > 0) {
+            this->idle_compute_services.insert(bare_metal_cs);
+        } else {
+            this->idle_compute_services.erase(bare_metal_cs);
+        }
+    }
+
+    /**
+     * @brief Register the hosts of a new compute service for the HEFT scheduler
+     *
+     * @param cs: a compute service
+     * @param vm_name: the name of the VM if the service runs on a VM, otherwise the empty string
+     */
+    void SimpleWMS::addExecutionHosts(const std::shared_ptr<BareMetalComputeService> &cs, const std::string &vm_name) {
+        if (this->scheduler_type != SchedulerType::HEFT) {
+            return;
+        }
+        auto core_flop_rates = cs->getCoreFlopRate();
+        for (auto const &[hostname, num_cores]: cs->getPerHostNumCores()) {
+            ExecutionHost host;
+            host.compute_service = cs;
+            host.physical_hostname = vm_name.empty() ? hostname : this->cloud_compute_service->getVMPhysicalHostname(vm_name);
+            host.num_idle_cores = num_cores;
+            host.core_flop_rate = core_flop_rates[hostname];
+            this->execution_hosts[hostname] = host;
+        }
+    }
+
+    /**
+     * @brief Return the cores of a submitted task to its host, used by the HEFT scheduler
+     *
+     * @param task: a completed or failed task
+     */
+    void SimpleWMS::releaseExecutionHost(const std::shared_ptr<WorkflowTask> &task) {
+        auto it = this->task_allocations.find(task);
+        if (it == this->task_allocations.end()) {
+            return;
+        }
+        // The host is not available anymore if the pilot job has expired
+        auto host = this->execution_hosts.find(it->second.first);
+        if (host != this->execution_hosts.end()) {
+            host->second.num_idle_cores += it->second.second;
+        }
+        this->task_allocations.erase(it);
+    }
+
+    /**
+     * @brief Compute upward ranks of all tasks as in HEFT: the rank of a task is its average computation time
+     *        plus the maximum over its children of the average transfer time of the data the child reads from the
+     *        task plus the child rank
+     */
+    void SimpleWMS::computeUpwardRanks() {
+        // Average time to compute a flop on a core of the compute hosts and to transfer a byte to them from the
+        // WMS host (over the bottleneck link of the route)
+        auto core_flop_rates = this->cloud_compute_service->getCoreFlopRate();
+        for (auto const &item: this->batch_compute_service->getCoreFlopRate()) {
+            core_flop_rates.insert(item);
+        }
+        double flop_time = 0;
+        double net_time = 0;
+        auto wms_host = simgrid::s4u::Host::by_name(this->getHostname());
+        for (auto const &[hostname, core_flop_rate]: core_flop_rates) {
+            flop_time += 1.0 / core_flop_rate;
+            std::vector<simgrid::s4u::Link *> links;
+            double latency = 0;
+            wms_host->route_to(simgrid::s4u::Host::by_name(hostname), links, &latency);
+            double bandwidth = std::numeric_limits<double>::infinity();
+            for (auto const &link: links) {
+                bandwidth = std::min(bandwidth, link->get_bandwidth());
+            }
+            net_time += 1.0 / bandwidth;
+        }
+        flop_time /= (double) core_flop_rates.size();
+        net_time /= (double) core_flop_rates.size();
+        this->net_time_per_byte = net_time;
+
+        auto tasks = this->workflow->getTasks();
+        std::unordered_set<std::shared_ptr<DataFile>> input_files;
+        for (auto const &task: tasks) {
+            for (auto const &f: task->getInputFiles()) {
+                input_files.insert(f);
+            }
+        }
+        for (auto const &task: tasks) {
+            for (auto const &f: task->getOutputFiles()) {
+                if (input_files.count(f)) {
+                    this->intermediate_files.insert(f);
+                }
+            }
+        }
+
+        // Children have greater top levels than their parents, so their ranks are computed first
+        std::sort(tasks.begin(), tasks.end(), [](const std::shared_ptr<WorkflowTask> &a, const std::shared_ptr<WorkflowTask> &b) {
+            return a->getTopLevel() > b->getTopLevel();
+        });
+        for (auto const &task: tasks) {
+            auto output_files = task->getOutputFiles();
+            std::unordered_set<std::shared_ptr<DataFile>> outputs(output_files.begin(), output_files.end());
+            double rank = 0;
+            for (auto const &child: task->getChildren()) {
+                double data_size = 0;
+                for (auto const &f: child->getInputFiles()) {
+                    if (outputs.count(f)) {
+                        data_size += f->getSize();
+                    }
+                }
+                rank = std::max(rank, this->upward_ranks[child] + data_size * net_time);
+            }
+            this->upward_ranks[task] = rank + task->getFlops() * flop_time;
+        }
+    }
+
+    /**
+     * @brief Get the location of a task input file for the HEFT scheduler: intermediate files are read from where
+     *        they were written, workflow input files from the WMS storage service
+     *
+     * @param file: a file
+     * @return a file location
+     */
+    std::shared_ptr<FileLocation> SimpleWMS::getInputFileLocation(const std::shared_ptr<DataFile> &file) const {
+        auto it = this->intermediate_file_locations.find(file);
+        return it != this->intermediate_file_locations.end() ? it->second : this->storage_service_location;
+    }
+
+    /**
+     * @brief Get the location of a task output file for the HEFT scheduler: intermediate files are written to the
+     *        storage service of the task host if there is one, workflow output files to the WMS storage service
+     *
+     * @param file: a file
+     * @param physical_hostname: the physical host of the task
+     * @return a file location
+     */
+    std::shared_ptr<FileLocation> SimpleWMS::getOutputFileLocation(const std::shared_ptr<DataFile> &file,
+                                                                   const std::string &physical_hostname) const {
+        if (this->intermediate_files.count(file)) {
+            auto it = this->local_storage_locations.find(physical_hostname);
+            if (it != this->local_storage_locations.end()) {
+                return it->second;
+            }
+        }
+        return this->storage_service_location;
+    }
+
+    /**
+     * @brief Account the files of a completed task that were read or written over the network
+     *
+     * @param task: a completed task
+     */
+    void SimpleWMS::addNumBytesTransferred(const std::shared_ptr<WorkflowTask> &task) {
+        auto const &hostname = task->getPhysicalExecutionHost();
+        for (auto const &[file, location]: this->getFileLocations(task)) {
+            if (location->getStorageService()->getHostname() != hostname) {
+                this->num_bytes_transferred += file->getSize();
+            }
+        }
+    }
+
+    /**
+     * @brief Get the locations of task input/output files, which are computed once per task
+     *
+     * @param task: a task
+     * @return a map of file locations
+     */
+    const std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> &
+    SimpleWMS::getFileLocations(const std::shared_ptr<WorkflowTask> &task) {
+        auto [it, inserted] = this->file_locations_cache.try_emplace(task);
+        if (inserted) {
+            // Specify that ALL files are read/written from the one storage service
+            for (auto const &f: task->getInputFiles()) {
+                it->second[f] = this->storage_service_location;
+            }
+            for (auto const &f: task->getOutputFiles()) {
+                it->second[f] = this->storage_service_location;
+            }
+        }
+        return it->second;
+    }
+
     /**
      * @brief Helper method to schedule a task one available compute services. This is a very, very
      *        simple/naive scheduling approach, that greedily runs tasks on idle cores of whatever
@@ -177,54 +726,144 @@ namespace wrench {
      *        sophisticated approaches/algorithms are possible. But this is sufficient for the sake
      *        of an example.
      *
-     * @param ready_task: the ready tasks to schedule
      * @param job_manager: a job manager
-     * @param compute_services: available compute services
      * @return
      */
-    void SimpleWMS::scheduleReadyTasks(std::vector<std::shared_ptr<WorkflowTask>> ready_tasks,
-                                       std::shared_ptr<JobManager> job_manager,
-                                       std::set<std::shared_ptr<BareMetalComputeService>> compute_services) {
+    void SimpleWMS::scheduleReadyTasks(const std::shared_ptr<JobManager> &job_manager) {
+
+        if (this->ready_tasks.empty()) {
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        unsigned long num_ready_tasks = this->ready_tasks.size();
+        WRENCH_INFO("Trying to schedule %lu ready tasks", num_ready_tasks);
+
+        unsigned long num_tasks_scheduled = 0;
+        while (not this->ready_tasks.empty() and not this->idle_compute_services.empty()) {
+            auto const &task = *this->ready_tasks.begin();
+            auto cs = *this->idle_compute_services.begin();
+            try {
+                auto job = job_manager->createStandardJob(task, this->getFileLocations(task));
+                WRENCH_INFO(
+                        "Submitting task %s to compute service %s", task->getID().c_str(),
+                        cs->getName().c_str());
+                job_manager->submitJob(job, cs);
+                this->setNumIdleCores(cs, this->core_utilization_map[cs] - 1);
+                this->queued_tasks.erase(task);
+                this->ready_tasks.erase(this->ready_tasks.begin());
+                num_tasks_scheduled++;
+            } catch (ExecutionException &e) {
+                WRENCH_INFO("WARNING: Was not able to submit task %s, likely due to the pilot job having expired "
+                            "(I should get a notification of its expiration soon)",
+                            task->getID().c_str());
+                break;
+            }
+        }
+        WRENCH_INFO("Was able to schedule %lu out of %lu ready tasks", num_tasks_scheduled, num_ready_tasks);
+        this->scheduling_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief Helper method to schedule ready tasks in the HEFT fashion. Tasks are taken in decreasing order of
+     *        upward rank, each one is placed on the host with the earliest estimated finish time, which accounts
+     *        for the transfers of the task files which are not on the host and for the number of cores the task
+     *        can use there. Idle cores are shared evenly between the ready tasks (within the task core limits),
+     *        so wide workflow phases run many tasks while narrow phases run fewer tasks on more cores. Intermediate
+     *        files are written to the storage service of the host, so children placed on the same host read them
+     *        locally.
+     *
+     * @param job_manager: a job manager
+     */
+    void SimpleWMS::scheduleRankedReadyTasks(const std::shared_ptr<JobManager> &job_manager) {
 
-        if (ready_tasks.empty()) {
+        if (this->ranked_ready_tasks.empty()) {
             return;
         }
 
-        WRENCH_INFO("Trying to schedule %lu ready tasks", ready_tasks.size());
+        auto start = std::chrono::steady_clock::now();
+        unsigned long num_ready_tasks = this->ranked_ready_tasks.size();
+        WRENCH_INFO("Trying to schedule %lu ready tasks in order of upward rank", num_ready_tasks);
+
+        unsigned long num_idle_cores = 0;
+        for (auto const &[hostname, host]: this->execution_hosts) {
+            num_idle_cores += host.num_idle_cores;
+        }
 
         unsigned long num_tasks_scheduled = 0;
-        for (auto const &task: ready_tasks) {
-            bool scheduled = false;
-            for (auto const &cs: compute_services) {
-                if (this->core_utilization_map[cs] > 0) {
-                    // Specify that ALL files are read/written from the one storage service
-                    std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> file_locations;
-                    for (auto const &f: task->getInputFiles()) {
-                        file_locations[f] = wrench::FileLocation::LOCATION(this->storage_service);
+        while (not this->ranked_ready_tasks.empty() and num_idle_cores > 0) {
+            auto task = this->ranked_ready_tasks.begin()->second;
+            unsigned long fair_num_cores = std::max(task->getMinNumCores(), num_idle_cores / this->ranked_ready_tasks.size());
+
+            std::string best_hostname;
+            unsigned long best_num_cores = 0;
+            double best_finish_time = std::numeric_limits<double>::infinity();
+            for (auto const &[hostname, host]: this->execution_hosts) {
+                if (host.num_idle_cores < task->getMinNumCores()) {
+                    continue;
+                }
+                unsigned long num_cores = std::min({host.num_idle_cores, task->getMaxNumCores(), fair_num_cores});
+                double remote_bytes = 0;
+                for (auto const &f: task->getInputFiles()) {
+                    if (this->getInputFileLocation(f)->getStorageService()->getHostname() != host.physical_hostname) {
+                        remote_bytes += f->getSize();
                     }
-                    for (auto const &f: task->getOutputFiles()) {
-                        file_locations[f] = wrench::FileLocation::LOCATION(this->storage_service);
+                }
+                for (auto const &f: task->getOutputFiles()) {
+                    if (this->getOutputFileLocation(f, host.physical_hostname)->getStorageService()->getHostname() != host.physical_hostname) {
+                        remote_bytes += f->getSize();
                     }
-                    try {
-                        auto job = job_manager->createStandardJob(task, file_locations);
-                        WRENCH_INFO(
-                                "Submitting task %s to compute service %s", task->getID().c_str(),
-                                cs->getName().c_str());
-                        job_manager->submitJob(job, cs);
-                        this->core_utilization_map[cs]--;
-                        num_tasks_scheduled++;
-                        scheduled = true;
-                    } catch (ExecutionException &e) {
-                        WRENCH_INFO("WARNING: Was not able to submit task %s, likely due to the pilot job having expired "
-                                    "(I should get a notification of its expiration soon)",
-                                    task->getID().c_str());
+                }
+                double finish_time = remote_bytes * this->net_time_per_byte +
+                                     task->getFlops() / (host.core_flop_rate * (double) num_cores);
+                if (finish_time < best_finish_time) {
+                    best_hostname = hostname;
+                    best_num_cores = num_cores;
+                    best_finish_time = finish_time;
+                }
+            }
+            // Lower ranked tasks are not scheduled before this one, even if they need fewer cores
+            if (best_hostname.empty()) {
+                break;
+            }
+
+            auto &host = this->execution_hosts[best_hostname];
+            auto &file_locations = this->file_locations_cache[task];
+            file_locations.clear();
+            for (auto const &f: task->getInputFiles()) {
+                file_locations[f] = this->getInputFileLocation(f);
+            }
+            for (auto const &f: task->getOutputFiles()) {
+                file_locations[f] = this->getOutputFileLocation(f, host.physical_hostname);
+            }
+            try {
+                auto job = job_manager->createStandardJob(task, file_locations);
+                WRENCH_INFO(
+                        "Submitting task %s (upward rank %.2f) to host %s of compute service %s with %lu cores",
+                        task->getID().c_str(), this->upward_ranks[task], best_hostname.c_str(),
+                        host.compute_service->getName().c_str(), best_num_cores);
+                job_manager->submitJob(job, host.compute_service,
+                                       {{task->getID(), best_hostname + ":" + std::to_string(best_num_cores)}});
+                host.num_idle_cores -= best_num_cores;
+                num_idle_cores -= best_num_cores;
+                this->task_allocations[task] = {best_hostname, best_num_cores};
+                for (auto const &f: task->getOutputFiles()) {
+                    if (this->intermediate_files.count(f)) {
+                        this->intermediate_file_locations[f] = file_locations[f];
                     }
-                    break;
                 }
+                this->queued_tasks.erase(task);
+                this->ranked_ready_tasks.erase(this->ranked_ready_tasks.begin());
+                num_tasks_scheduled++;
+            } catch (ExecutionException &e) {
+                WRENCH_INFO("WARNING: Was not able to submit task %s, likely due to the pilot job having expired "
+                            "(I should get a notification of its expiration soon)",
+                            task->getID().c_str());
+                break;
             }
-            if (not scheduled) break;
         }
-        WRENCH_INFO("Was able to schedule %lu out of %lu ready tasks", num_tasks_scheduled, ready_tasks.size());
+        WRENCH_INFO("Was able to schedule %lu out of %lu ready tasks", num_tasks_scheduled, num_ready_tasks);
+        this->scheduling_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     }
 
 }// namespace wrench
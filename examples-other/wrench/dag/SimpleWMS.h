@@ -10,10 +10,61 @@
 #ifndef WRENCH_EXAMPLE_SIMPLEWMS_H
 #define WRENCH_EXAMPLE_SIMPLEWMS_H
 
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
 #include <wrench-dev.h>
 
 namespace wrench {
 
+    /**
+     *  @brief Summary statistics of task executions accumulated as tasks complete
+     */
+    struct TaskCompletionStats {
+        /** @brief Number of completed tasks */
+        unsigned long num_completed_tasks = 0;
+        /** @brief Number of tasks that failed at least once */
+        unsigned long num_failed_tasks = 0;
+        /** @brief Sum of computation time / communication+IO time ratios over completed tasks */
+        double computation_communication_ratio_sum = 0.0;
+    };
+
+    /**
+     *  @brief Orders tasks by ID, which is the order of Workflow::getReadyTasks()
+     */
+    struct TaskIDLess {
+        /** @brief Compare task IDs */
+        bool operator()(const std::shared_ptr<WorkflowTask> &a, const std::shared_ptr<WorkflowTask> &b) const {
+            return a->getID() < b->getID();
+        }
+    };
+
+    /**
+     *  @brief Policies of scheduling ready tasks on the available compute services
+     */
+    enum class SchedulerType {
+        /** @brief Ready tasks in order of task ID on any service with an idle core, 1 core per task, all files on the WMS storage service */
+        NAIVE,
+        /** @brief Ready tasks in order of upward rank (as in HEFT) on the host with the earliest estimated finish time,
+         *         multiple cores per task, intermediate files on the storage service of the host that produced them */
+        HEFT
+    };
+
+    /**
+     *  @brief A host of an available compute service, which is tracked by the HEFT scheduler
+     */
+    struct ExecutionHost {
+        /** @brief The compute service that runs tasks on the host */
+        std::shared_ptr<BareMetalComputeService> compute_service;
+        /** @brief The physical host, which differs from the execution host for VMs */
+        std::string physical_hostname;
+        /** @brief Number of cores that are not used by submitted tasks */
+        unsigned long num_idle_cores = 0;
+        /** @brief Flop rate of a core */
+        double core_flop_rate = 0.0;
+    };
+
     /**
      *  @brief A simple WMS implementation
      */
@@ -24,7 +75,32 @@ namespace wrench {
                   const std::shared_ptr<BatchComputeService> &batch_compute_service,
                   const std::shared_ptr<CloudComputeService> &cloud_compute_service,
                   const std::shared_ptr<StorageService> &storage_service,
-                  const std::string &hostname);
+                  const std::string &hostname,
+                  bool online_stats = false,
+                  SchedulerType scheduler_type = SchedulerType::NAIVE,
+                  const std::map<std::string, std::shared_ptr<StorageService>> &local_storage_services = {},
+                  bool autoscaling = false);
+
+        /** @brief Get the total wall-clock time spent in scheduleReadyTasks, in seconds */
+        double getSchedulingTime() const;
+
+        /** @brief Get task completion statistics, which are collected only with online_stats enabled */
+        const TaskCompletionStats &getTaskCompletionStats() const;
+
+        /** @brief Get the number of bytes of task input/output files read or written over the network by completed tasks */
+        double getNumBytesTransferred() const;
+
+        /** @brief Get the number of core-hours of the VMs and pilot jobs used until the end of the workflow execution */
+        double getCoreHoursUsed() const;
+
+        /** @brief Number of cores of the VMs */
+        static constexpr unsigned long VM_NUM_CORES = 4;
+        /** @brief Period of autoscaling decisions, in seconds */
+        static constexpr double AUTOSCALING_INTERVAL = 60;
+        /** @brief Weight of the last completed task in the moving average of task durations */
+        static constexpr double TASK_DURATION_WEIGHT = 0.1;
+        /** @brief Ratio of the pilot job time limit to the estimated time to run its share of the ready tasks */
+        static constexpr double PILOT_JOB_TIME_LIMIT_FACTOR = 2;
 
     protected:
         void processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> event) override;
@@ -42,17 +118,104 @@ namespace wrench {
         std::shared_ptr<PilotJob> pilot_job = nullptr;
         /** @brief A boolean to indicate whether the pilot job is running */
         bool pilot_job_is_running = false;
+        /** @brief Number of cores requested by the pilot job */
+        unsigned long num_pilot_job_cores = 0;
+
+        void scheduleReadyTasks(const std::shared_ptr<JobManager> &job_manager);
+
+        void scheduleRankedReadyTasks(const std::shared_ptr<JobManager> &job_manager);
+
+        void enqueueReadyTask(const std::shared_ptr<WorkflowTask> &task);
+        void setNumIdleCores(const std::shared_ptr<ComputeService> &cs, unsigned long num_idle_cores);
+        const std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> &
+        getFileLocations(const std::shared_ptr<WorkflowTask> &task);
 
-        void scheduleReadyTasks(std::vector<std::shared_ptr<WorkflowTask>> ready_tasks,
-                                std::shared_ptr<JobManager> job_manager,
-                                std::set<std::shared_ptr<BareMetalComputeService>> compute_services);
+        void computeUpwardRanks();
+        void addExecutionHosts(const std::shared_ptr<BareMetalComputeService> &cs, const std::string &vm_name = "");
+        void releaseExecutionHost(const std::shared_ptr<WorkflowTask> &task);
+        std::shared_ptr<FileLocation> getInputFileLocation(const std::shared_ptr<DataFile> &file) const;
+        std::shared_ptr<FileLocation> getOutputFileLocation(const std::shared_ptr<DataFile> &file,
+                                                            const std::string &physical_hostname) const;
+        void addNumBytesTransferred(const std::shared_ptr<WorkflowTask> &task);
+
+        void autoscale(const std::shared_ptr<JobManager> &job_manager);
+        void addVM(unsigned long num_cores);
+        void removeComputeService(const std::shared_ptr<BareMetalComputeService> &cs);
+        unsigned long getNumIdleCores(const std::shared_ptr<BareMetalComputeService> &cs);
+        double estimateTaskDuration() const;
+        void startLease(const std::shared_ptr<BareMetalComputeService> &cs, unsigned long num_cores);
+        void endLease(const std::shared_ptr<BareMetalComputeService> &cs);
 
         std::shared_ptr<Workflow> workflow;
         std::shared_ptr<BatchComputeService> batch_compute_service;
         std::shared_ptr<CloudComputeService> cloud_compute_service;
         std::shared_ptr<StorageService> storage_service;
 
+        /** @brief Currently available bare-metal services (on VMs and perhaps within pilot job as well) */
+        std::vector<std::shared_ptr<BareMetalComputeService>> compute_services;
+
         std::map<std::shared_ptr<ComputeService>, unsigned long> core_utilization_map;
+        /** @brief Available compute services which have idle cores */
+        std::set<std::shared_ptr<BareMetalComputeService>> idle_compute_services;
+
+        /** @brief Ready tasks which are not submitted yet, in order of task ID as returned by Workflow::getReadyTasks() */
+        std::set<std::shared_ptr<WorkflowTask>, TaskIDLess> ready_tasks;
+        std::unordered_set<std::shared_ptr<WorkflowTask>> queued_tasks;
+
+        /** @brief File locations of tasks that are not completed yet */
+        std::unordered_map<std::shared_ptr<WorkflowTask>, std::map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>>> file_locations_cache;
+        std::shared_ptr<FileLocation> storage_service_location;
+
+        double scheduling_time = 0;
+
+        /** @brief Whether task completion statistics are accumulated in processEventStandardJobCompletion */
+        bool online_stats;
+        TaskCompletionStats task_completion_stats;
+
+        double num_bytes_transferred = 0;
+
+        SchedulerType scheduler_type;
+
+        /** @brief Storage services on compute hosts (by physical hostname), used by the HEFT scheduler for intermediate files */
+        std::map<std::string, std::shared_ptr<StorageService>> local_storage_services;
+        std::map<std::string, std::shared_ptr<FileLocation>> local_storage_locations;
+
+        /** @brief Upward ranks of tasks: estimated length of the critical path from the task start to the workflow end */
+        std::unordered_map<std::shared_ptr<WorkflowTask>, double> upward_ranks;
+        /** @brief Ready tasks which are not submitted yet, in decreasing order of upward rank (HEFT scheduler only) */
+        std::multimap<double, std::shared_ptr<WorkflowTask>, std::greater<>> ranked_ready_tasks;
+
+        /** @brief Hosts of the available compute services by execution hostname (HEFT scheduler only) */
+        std::map<std::string, ExecutionHost> execution_hosts;
+        /** @brief Execution hostname and number of cores of submitted tasks (HEFT scheduler only) */
+        std::unordered_map<std::shared_ptr<WorkflowTask>, std::pair<std::string, unsigned long>> task_allocations;
+
+        /** @brief Files which are produced and consumed by workflow tasks */
+        std::unordered_set<std::shared_ptr<DataFile>> intermediate_files;
+        /** @brief Locations of the intermediate files written by submitted tasks */
+        std::unordered_map<std::shared_ptr<DataFile>, std::shared_ptr<FileLocation>> intermediate_file_locations;
+
+        /** @brief Average time to transfer a byte between the WMS host and a compute host, used in upward ranks */
+        double net_time_per_byte = 0;
+
+        /** @brief Whether VMs and pilot jobs are started and released depending on the ready tasks (see autoscale) */
+        bool autoscaling;
+        /** @brief Maximum number of VMs that fit on the cloud hosts */
+        unsigned long max_num_vms = 0;
+        /** @brief Number of batch compute nodes, the number of cores and the core flop rate of a node */
+        unsigned long num_batch_nodes = 0;
+        unsigned long batch_node_num_cores = 0;
+        double batch_core_flop_rate = 0;
+
+        /** @brief Names of the running VMs by their compute services */
+        std::map<std::shared_ptr<BareMetalComputeService>, std::string> vm_names;
+        /** @brief Start dates and numbers of cores of the running VMs and pilot jobs */
+        std::map<std::shared_ptr<BareMetalComputeService>, std::pair<double, unsigned long>> leases;
+        double core_seconds_used = 0;
+        /** @brief Dates since which the compute services have all their cores idle, updated by autoscale */
+        std::map<std::shared_ptr<BareMetalComputeService>, double> idle_since;
+        /** @brief Moving average of the durations of completed tasks, 0 until a task completes */
+        double recent_task_duration = 0;
     };
 }// namespace wrench
 #endif//WRENCH_EXAMPLE_SIMPLEWMS_H
@@ -7,7 +7,12 @@
  * (at your option) any later version.
  */
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <sys/resource.h>
 #include <wrench.h>
 
 #include "SimpleWMS.h"
@@ -17,6 +22,25 @@ static bool ends_with(const std::string &str, const std::string &suffix) {
     return str.size() >= suffix.size() && 0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix);
 }
 
+/**
+ * @brief Get the peak resident set size of the process
+ * @return peak RSS in KB
+ */
+static long get_peak_rss() {
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief Get the number of seconds elapsed since some time point
+ * @param start: the time point
+ * @return elapsed time in seconds
+ */
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
 /**
  * @brief An example that demonstrate how to run a simulation of a simple Workflow
  *        Management System (WMS) (implemented in SimpleWMS.[cpp|h]).
@@ -26,6 +50,7 @@ static bool ends_with(const std::string &str, const std::string &suffix) {
  * @return 0 if the simulation has successfully completed
  */
 int main(int argc, char **argv) {
+    auto start_time = std::chrono::steady_clock::now();
 
     /*
      * Declaration of the top-level WRENCH simulation object
@@ -43,22 +68,58 @@ int main(int argc, char **argv) {
     /*
      * Parsing of the command-line arguments for this WRENCH simulation
      */
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <xml platform file> <workflow file> [--log=simple_wms.threshold=info]" << std::endl;
+    /* --online-stats makes the WMS accumulate summary statistics while tasks complete instead of
+     * collecting the full trace, and skips the workflow JSON dump unless --dump-json is also passed */
+    /* --scheduler selects the WMS scheduler (naive or heft, see wrench::SchedulerType), --max-cores-per-task sets
+     * the maximum number of cores of the workflow tasks which do not specify it in the workflow file, --autoscaling
+     * makes the WMS start and release VMs and pilot jobs depending on the ready tasks */
+    bool online_stats = false;
+    bool dump_json = false;
+    bool autoscaling = false;
+    std::string scheduler = "naive";
+    unsigned long max_cores_per_task = 1;
+    bool bad_args = false;
+    std::vector<char *> positional_args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--online-stats") {
+            online_stats = true;
+        } else if (arg == "--dump-json") {
+            dump_json = true;
+        } else if (arg == "--autoscaling") {
+            autoscaling = true;
+        } else if (arg == "--scheduler" and i + 1 < argc) {
+            scheduler = argv[++i];
+            bad_args = bad_args or (scheduler != "naive" and scheduler != "heft");
+        } else if (arg == "--max-cores-per-task" and i + 1 < argc) {
+            max_cores_per_task = std::strtoul(argv[++i], nullptr, 10);
+            bad_args = bad_args or max_cores_per_task == 0;
+        } else {
+            positional_args.push_back(argv[i]);
+        }
+    }
+    dump_json = dump_json or not online_stats;
+    auto scheduler_type = scheduler == "heft" ? wrench::SchedulerType::HEFT : wrench::SchedulerType::NAIVE;
+
+    if (positional_args.size() != 2 or bad_args) {
+        std::cerr << "Usage: " << argv[0] << " <xml platform file> <workflow file> [--online-stats] [--dump-json] "
+                  << "[--scheduler naive|heft] [--max-cores-per-task N] [--autoscaling] [--log=simple_wms.threshold=info]"
+                  << std::endl;
         exit(1);
     }
 
     /* The first argument is the platform description file, written in XML following the SimGrid-defined DTD */
-    char *platform_file = argv[1];
+    char *platform_file = positional_args[0];
     /* The second argument is the workflow description file, written in JSON using WfCommons's WfFormat format */
-    char *workflow_file = argv[2];
+    char *workflow_file = positional_args[1];
 
 
     /* Reading and parsing the workflow description file to create a wrench::Workflow object */
     std::cerr << "Loading workflow..." << std::endl;
     std::shared_ptr<wrench::Workflow> workflow;
     if (ends_with(workflow_file, "json")) {
-        workflow = wrench::WfCommonsWorkflowParser::createWorkflowFromJSON(workflow_file, "100Gf");
+        workflow = wrench::WfCommonsWorkflowParser::createWorkflowFromJSON(workflow_file, "100Gf", false, false, 1,
+                                                                           max_cores_per_task);
     } else {
         std::cerr << "Workflow file name must end with '.json'" << std::endl;
         exit(1);
@@ -73,6 +134,17 @@ int main(int argc, char **argv) {
     /* Get a vector of all the hosts in the simulated platform */
     std::vector<std::string> hostname_list = wrench::Simulation::getHostnameList();
 
+    /* Compute nodes of the batch and cloud services are the hosts named BatchNode* and CloudNode* */
+    std::vector<std::string> batch_nodes;
+    std::vector<std::string> cloud_nodes;
+    for (auto const &hostname: hostname_list) {
+        if (hostname.rfind("BatchNode", 0) == 0) {
+            batch_nodes.push_back(hostname);
+        } else if (hostname.rfind("CloudNode", 0) == 0) {
+            cloud_nodes.push_back(hostname);
+        }
+    }
+
     /* Create a list of storage services that will be used by the WMS */
     std::set<std::shared_ptr<wrench::StorageService>> storage_services;
 
@@ -89,6 +161,22 @@ int main(int argc, char **argv) {
     auto storage_service = simulation->add(new wrench::SimpleStorageService({"WMSHost"}, {"/"}));
     storage_services.insert(storage_service);
 
+    /* The HEFT scheduler writes intermediate files to storage services on the compute hosts which have a disk
+     * mounted at /scratch, so that tasks placed on the same host as their parents read them without network
+     * transfers. The scratch space of compute services cannot be used for this, as it is cleaned up after
+     * each job. */
+    std::map<std::string, std::shared_ptr<wrench::StorageService>> local_storage_services;
+    if (scheduler_type == wrench::SchedulerType::HEFT) {
+        for (auto const &hostname: hostname_list) {
+            if (hostname != "WMSHost" and wrench::Simulation::hostHasMountPoint(hostname, "/scratch")) {
+                std::cerr << "Instantiating a SimpleStorageService on " << hostname << std::endl;
+                auto local_storage_service = simulation->add(new wrench::SimpleStorageService(hostname, {"/scratch"}));
+                storage_services.insert(local_storage_service);
+                local_storage_services[hostname] = local_storage_service;
+            }
+        }
+    }
+
 
     /* Create a list of compute services that will be used by the WMS */
     std::set<std::shared_ptr<wrench::ComputeService>> compute_services;
@@ -115,7 +203,7 @@ int main(int argc, char **argv) {
 #endif
     try {
         batch_compute_service = simulation->add(new wrench::BatchComputeService(
-                {"BatchHeadNode"}, {{"BatchNode1"}, {"BatchNode2"}}, "",
+                {"BatchHeadNode"}, batch_nodes, "",
                 {{wrench::BatchComputeServiceProperty::BATCH_SCHEDULING_ALGORITHM, scheduling_algorithm}},
                 {{wrench::BatchComputeServiceMessagePayload::STOP_DAEMON_MESSAGE_PAYLOAD, 2048}}));
     } catch (std::invalid_argument &e) {
@@ -136,7 +224,7 @@ int main(int argc, char **argv) {
     std::shared_ptr<wrench::CloudComputeService> cloud_compute_service;
     try {
         cloud_compute_service = simulation->add(new wrench::CloudComputeService(
-                {"CloudHeadNode"}, {{"CloudNode1"}, {"CloudNode2"}}, "", {},
+                {"CloudHeadNode"}, cloud_nodes, "", {},
                 {{wrench::CloudComputeServiceMessagePayload::STOP_DAEMON_MESSAGE_PAYLOAD, 1024}}));
     } catch (std::invalid_argument &e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -148,10 +236,11 @@ int main(int argc, char **argv) {
      *
      * The WMS implementation is in SimpleWMS.[cpp|h].
      */
-    std::cerr << "Instantiating a WMS on WMSHost..." << std::endl;
+    std::cerr << "Instantiating a WMS on WMSHost with " << scheduler << " scheduler..." << std::endl;
     auto wms = simulation->add(
             new wrench::SimpleWMS(workflow, batch_compute_service,
-                                  cloud_compute_service, storage_service, {"WMSHost"}));
+                                  cloud_compute_service, storage_service, {"WMSHost"}, online_stats,
+                                  scheduler_type, local_storage_services, autoscaling));
 
     /* Instantiate a file registry service to be started on some host. This service is
      * essentially a replica catalog that stores <file , storage service> pairs so that
@@ -177,44 +266,74 @@ int main(int argc, char **argv) {
         }
     }
 
-    /* Enable some output time stamps */
-    simulation->getOutput().enableWorkflowTaskTimestamps(true);
+    /* Enable some output time stamps, which are not needed if statistics are collected online */
+    simulation->getOutput().enableWorkflowTaskTimestamps(not online_stats);
+
+    /* Everything before the launch (workflow parsing, platform, services, file staging) is reported as setup */
+    double setup_time = seconds_since(start_time);
+    long setup_rss = get_peak_rss();
 
     /* Launch the simulation. This call only returns when the simulation is complete. */
     std::cerr << "Launching the Simulation..." << std::endl;
+    auto run_start_time = std::chrono::steady_clock::now();
     try {
         simulation->launch();
     } catch (std::runtime_error &e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return 0;
     }
+    double run_time = seconds_since(run_start_time);
     std::cerr << "Simulation done!" << std::endl;
     std::cerr << "Workflow completed at time: " << workflow->getCompletionDate() << std::endl;
+    std::cerr << "Scheduling time: " << wms->getSchedulingTime() << "s" << std::endl;
+    std::cerr << "Bytes transferred: " << std::fixed << std::setprecision(0) << wms->getNumBytesTransferred()
+              << std::defaultfloat << std::endl;
+    std::cerr << "Core-hours used: " << wms->getCoreHoursUsed() << std::endl;
 
-    simulation->getOutput().dumpWorkflowGraphJSON(workflow, "/tmp/workflow.json", true);
+    if (dump_json) {
+        simulation->getOutput().dumpWorkflowGraphJSON(workflow, "/tmp/workflow.json", true);
+    }
 
-    /* Simulation results can be examined via simulation->getOutput(), which provides access to traces
-     * of events. In the code below, go through some time-stamps and compute some statistics.
-     */
-    std::vector<wrench::SimulationTimestamp<wrench::SimulationTimestampTaskCompletion> *> trace;
-    trace = simulation->getOutput().getTrace<wrench::SimulationTimestampTaskCompletion>();
-    std::cerr << "Number of entries in TaskCompletion trace: " << trace.size() << std::endl;
     unsigned long num_failed_tasks = 0;
     double computation_communication_ratio_average = 0.0;
-    for (const auto &item: trace) {
-        auto task = item->getContent()->getTask();
-        if (task->getExecutionHistory().size() > 1) {
-            num_failed_tasks++;
+    if (online_stats) {
+        /* Statistics were accumulated by the WMS as tasks completed, so that memory usage does not
+         * depend on the trace size */
+        auto const &stats = wms->getTaskCompletionStats();
+        std::cerr << "Number of completed tasks: " << stats.num_completed_tasks << std::endl;
+        num_failed_tasks = stats.num_failed_tasks;
+        computation_communication_ratio_average = stats.computation_communication_ratio_sum / (double) (stats.num_completed_tasks);
+    } else {
+        /* Simulation results can be examined via simulation->getOutput(), which provides access to traces
+         * of events. In the code below, go through some time-stamps and compute some statistics.
+         */
+        std::vector<wrench::SimulationTimestamp<wrench::SimulationTimestampTaskCompletion> *> trace;
+        trace = simulation->getOutput().getTrace<wrench::SimulationTimestampTaskCompletion>();
+        std::cerr << "Number of entries in TaskCompletion trace: " << trace.size() << std::endl;
+        for (const auto &item: trace) {
+            auto task = item->getContent()->getTask();
+            if (task->getExecutionHistory().size() > 1) {
+                num_failed_tasks++;
+            }
+            double io_time = task->getExecutionHistory().top().read_input_end - task->getExecutionHistory().top().read_input_start;
+            io_time += task->getExecutionHistory().top().write_output_end - task->getExecutionHistory().top().write_output_start;
+            double compute_time = task->getExecutionHistory().top().computation_end - task->getExecutionHistory().top().computation_start;
+            computation_communication_ratio_average += compute_time / io_time;
         }
-        double io_time = task->getExecutionHistory().top().read_input_end - task->getExecutionHistory().top().read_input_start;
-        io_time += task->getExecutionHistory().top().write_output_end - task->getExecutionHistory().top().write_output_start;
-        double compute_time = task->getExecutionHistory().top().computation_end - task->getExecutionHistory().top().computation_start;
-        computation_communication_ratio_average += compute_time / io_time;
+        computation_communication_ratio_average /= (double) (trace.size());
     }
-    computation_communication_ratio_average /= (double) (trace.size());
 
     std::cerr << "Number of tasks that failed at least once: " << num_failed_tasks << "\n";
     std::cerr << "Average computation time / communication+IO time ratio over all tasks: " << computation_communication_ratio_average << "\n";
 
+    /* Machine-readable summary in the same format as the SimGrid examples (see examples-other/benchmark.py),
+     * completed tasks are reported as events */
+    unsigned long num_tasks = workflow->getNumberOfTasks();
+    printf("RESULT {\"example\": \"wrench-dag\", \"wall_time\": %.6f, \"setup_time\": %.6f, "
+           "\"run_time\": %.6f, \"sim_time\": %.6f, \"events\": %lu, \"events_per_sec\": %.1f, "
+           "\"setup_rss_kb\": %ld, \"peak_rss_kb\": %ld}\n",
+           seconds_since(start_time), setup_time, run_time, workflow->getCompletionDate(), num_tasks,
+           run_time > 0 ? num_tasks / run_time : 0., setup_rss, get_peak_rss());
+
     return 0;
 }
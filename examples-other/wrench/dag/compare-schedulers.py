@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+
+# Runs the WRENCH workflow simulator with the naive and HEFT schedulers, with static resources or with
+# autoscaling, and prints the makespan, the number of bytes of task files transferred over the network and
+# the core-hours of VMs and pilot jobs used for each of them.
+#
+# Examples (from this directory, after building):
+#
+#   ./compare-schedulers.py --workflows ../../../examples/dag-benchmark/dags/montage.json --max-cores 1,4
+#   ./compare-schedulers.py --platform cloud_batch_platform2.xml --provisioning static,autoscaling
+
+import argparse
+import itertools
+import json
+import os
+import re
+import subprocess
+import sys
+
+
+RESULT_REGEX = re.compile(r"^RESULT (\{.*\})$", re.MULTILINE)
+MAKESPAN_REGEX = re.compile(r"^Workflow completed at time: ([\d\.e\+]+)$", re.MULTILINE)
+BYTES_REGEX = re.compile(r"^Bytes transferred: (\d+)$", re.MULTILINE)
+CORE_HOURS_REGEX = re.compile(r"^Core-hours used: ([\d\.e\+]+)$", re.MULTILINE)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--binary", default="./wrench-example-real-workflow")
+    ap.add_argument("--platform", default="cloud_batch_platform.xml")
+    ap.add_argument("--workflows", default="../../../examples/dag-benchmark/dags/montage.json",
+                    help="Comma-separated list of workflow files")
+    ap.add_argument("--schedulers", default="naive,heft",
+                    help="Comma-separated list of schedulers: naive, heft")
+    ap.add_argument("--max-cores", default="1",
+                    help="Comma-separated list of maximum numbers of cores per task")
+    ap.add_argument("--provisioning", default="static",
+                    help="Comma-separated list of resource provisioning modes: static, autoscaling")
+    ap.add_argument("extra_args", nargs="*", help="Additional simulator arguments (after --)")
+    args = ap.parse_args()
+
+    header = ["workflow", "max cores", "scheduler", "provisioning", "makespan, s",
+              "transferred, GB", "core-hours", "run time, s", "peak RSS, KB"]
+    rows = []
+    for workflow, max_cores, scheduler, provisioning in itertools.product(
+            args.workflows.split(","), args.max_cores.split(","), args.schedulers.split(","),
+            args.provisioning.split(",")):
+        command = [args.binary, args.platform, workflow, "--online-stats", "--scheduler", scheduler,
+                   "--max-cores-per-task", max_cores, "--wrench-mailbox-pool-size=1000000"]
+        if provisioning == "autoscaling":
+            command.append("--autoscaling")
+        name = os.path.basename(workflow)
+        print(f"Running {name} with {scheduler} scheduler, {max_cores} cores per task, "
+              f"{provisioning} provisioning", file=sys.stderr)
+        proc = subprocess.run(command + args.extra_args, stdout=subprocess.PIPE,
+                              stderr=subprocess.PIPE, text=True)
+        m = RESULT_REGEX.search(proc.stdout)
+        makespan = MAKESPAN_REGEX.search(proc.stderr)
+        transferred = BYTES_REGEX.search(proc.stderr)
+        core_hours = CORE_HOURS_REGEX.search(proc.stderr)
+        if proc.returncode != 0 or None in (m, makespan, transferred, core_hours):
+            rows.append([name, max_cores, scheduler, provisioning, "failed", "-", "-", "-", "-"])
+            continue
+        result = json.loads(m.group(1))
+        rows.append([name, max_cores, scheduler, provisioning, f"{float(makespan.group(1)):.1f}",
+                     f"{int(transferred.group(1)) / 1e9:.3f}", f"{float(core_hours.group(1)):.2f}",
+                     f"{result['run_time']:.3f}", str(result["peak_rss_kb"])])
+
+    widths = [max(len(x) for x in column) for column in zip(header, *rows)]
+    for row in [header] + rows:
+        print("  ".join(x.ljust(w) for x, w in zip(row, widths)).rstrip())
+
+
+if __name__ == "__main__":
+    main()